@@ -80,6 +80,22 @@ int archBits(){
 	}
 }
 
+// Measures readCycles() against the monotonic clock over ~10ms.
+double calibrateCycles(){
+	struct timespec t0, t1, pause = {0, 10000000};
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	uint64_t c0 = readCycles();
+	nanosleep(&pause, NULL);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	uint64_t c1 = readCycles();
+	int64_t ns = ((int64_t)t1.tv_sec - t0.tv_sec) * 1000000000LL
+		+ ((int64_t)t1.tv_nsec - t0.tv_nsec);
+	if(ns <= 0 || c1 <= c0){
+		return 1.0;
+	}
+	return (double)(c1 - c0) / ns;
+}
+
 unsigned int nextRand(unsigned int last) {
 	unsigned int next = last;
 	next = next * 1664525 + 1013904223;
@@ -28,6 +28,8 @@ limitations under the License.
 #include <stdlib.h>
 #include <unistd.h>
 #include <string>
+#include <stdint.h>
+#include <time.h>
 
 // UTILITY CODE -----------------------------
 void errexit (const char *err_str);
@@ -37,6 +39,21 @@ int warmMemory(unsigned int megabytes);
 bool isInteger(const std::string & s);
 std::string machineName();
 int archBits();
+double calibrateCycles();
+
+// Cheap timestamp for per-operation timing: the TSC on x86, the
+// monotonic clock elsewhere.  Divide by gtc->cycles_per_ns for ns.
+inline uint64_t readCycles(){
+#if defined(__x86_64__) || defined(__i386__)
+	uint32_t lo, hi;
+	__asm__ __volatile__ ("rdtsc" : "=a"(lo), "=d"(hi));
+	return ((uint64_t)hi << 32) | lo;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
 
 inline int64_t timeDiff(struct timeval* start, struct timeval* end){
 	int64_t ret =  (((int64_t)end->tv_sec)-start->tv_sec)*(1000000);
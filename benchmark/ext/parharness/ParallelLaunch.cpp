@@ -51,6 +51,22 @@ void alarmhandler(int sig){
 }
 
 
+// TIMER --------------------------------------------------
+// Ends the test interval by raising gtc->stop, so the tests
+// don't have to read the clock after every operation.
+pthread_t timer;
+static void * timer_main (void *lp)
+{
+	GlobalTestConfig* gtc = (GlobalTestConfig*) lp;
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	end.tv_sec += gtc->interval;
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &end, NULL) == EINTR){}
+	gtc->stop.store(true, std::memory_order_release);
+	return NULL;
+}
+
+
 // AFFINITY ----------------------------------------------
 
 /*
@@ -122,6 +138,7 @@ static void * thread_main (void *lp)
         	gettimeofday (&gtc->start, NULL);
         	gtc->finish=gtc->start;
 			gtc->finish.tv_sec+=gtc->interval;
+			pthread_create (&timer, NULL, timer_main, gtc);
 	}
 
 
@@ -154,6 +171,8 @@ void parallelWork(GlobalTestConfig* gtc){
 
 	// init globals
 	initSynchronizationPrimitives(task_num);
+	gtc->cycles_per_ns = calibrateCycles();
+	gtc->stop.store(false);
 	initTest(gtc);
 	testComplete = false;
 
@@ -193,6 +212,7 @@ void parallelWork(GlobalTestConfig* gtc){
 	// join threads ------------------
 	for (i = 1; i < task_num; i++)
     	pthread_join (threads[i], NULL);
+	pthread_join (timer, NULL);
 
 	for (i = 0; i < task_num; i++) {
 		delete ctcs[i].ltc;
@@ -33,6 +33,7 @@ limitations under the License.
 #include <sys/time.h>	
 #include <sys/resource.h>
 #include <hwloc.h>
+#include <atomic>
 
 
 #include "Rideable.hpp"
@@ -57,6 +58,8 @@ public:
 	int task_num = 4;  // number of threads
 	struct timeval start, finish; // timing structures
 	long unsigned int interval = 2;  // number of seconds to run test
+	std::atomic<bool> stop{false}; // set by the timer thread when interval is over
+	double cycles_per_ns = 1.0; // rate of readCycles(), from calibrateCycles()
 
 	std::vector<hwloc_obj_t> affinities; // map from tid to CPU id
 	hwloc_topology_t topology;
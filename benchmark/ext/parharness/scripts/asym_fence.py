@@ -0,0 +1,47 @@
+#!/usr/bin/python
+
+# Compares trackers that publish reservations with seq_cst stores
+# against their membarrier-based variants (-dtracker=<name>Asym) on
+# the read-mostly ObjRetire:g90p10 test, for each rideable and
+# thread count. No multicore results have been collected yet.
+#
+# Usage:
+#   asym_fence.py [harness args] [-r R ...] [--threads 1,2,4] [--pair Hazard:HazardAsym]
+# e.g.
+#   asym_fence.py -i 5 -r 1 -r 2 -r 4 --threads 1,4,16,64
+
+from os.path import dirname, realpath
+from argparse import ArgumentParser
+import subprocess
+import sys
+
+BIN = dirname(realpath(__file__)) + "/../../../bin"
+PAIRS = ["Hazard:HazardAsym", "HE:HEAsym", "HR:HRAsym", "RCU:RCUAsym"]
+
+def throughput(binary, args, rideable, threads, tracker):
+	cmd = [binary] + args + ["-m", "2", "-r", rideable, "-t", str(threads),
+		"-dtracker=" + tracker]
+	out = subprocess.check_output(cmd).decode()
+	return int(out.split()[-1])
+
+if __name__ == "__main__":
+	parser = ArgumentParser()
+	parser.add_argument("--pair", action="append", default=[],
+		help="<seq_cst tracker>:<asym tracker>")
+	parser.add_argument("-r", dest="rideables", action="append", default=[])
+	parser.add_argument("--threads", default="1,2,4,8")
+	parser.add_argument("--exe", default="intmain")
+	opts, args = parser.parse_known_args()
+	pairs = opts.pair or PAIRS
+	rideables = opts.rideables or ["1"]
+
+	print("%-4s %-8s %-10s %14s %14s %8s" % ("r", "threads", "tracker", "seq_cst", "asym", "delta"))
+	for r in rideables:
+		for t in opts.threads.split(","):
+			for pair in pairs:
+				base, asym = pair.split(":")
+				sc = throughput(BIN + "/" + opts.exe, args, r, t, base)
+				af = throughput(BIN + "/" + opts.exe, args, r, t, asym)
+				delta = 100.0 * (af - sc) / sc if sc else 0.0
+				print("%-4s %-8s %-10s %14d %14d %+7.2f%%" % (r, t, base, sc, af, delta))
+				sys.stdout.flush()
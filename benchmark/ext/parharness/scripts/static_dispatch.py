@@ -0,0 +1,37 @@
+#!/usr/bin/python
+
+# Compares the runtime-dispatched binary (bin/main) against binaries
+# built with a compile-time tracker (make TRACKER=<Class>).
+#
+# Usage:
+#   static_dispatch.py [harness args] --pair HRTracker:HR --pair RCUTracker:RCU
+# e.g.
+#   static_dispatch.py -i 5 -m 3 -r 1 -t 8 --pair HRTracker:HR
+
+from os.path import dirname, realpath
+from argparse import ArgumentParser
+import subprocess
+import sys
+
+BIN = dirname(realpath(__file__)) + "/../../../bin"
+
+def throughput(binary, args, tracker):
+	cmd = [binary] + args + ["-dtracker=" + tracker]
+	out = subprocess.check_output(cmd).decode()
+	return int(out.split()[-1])
+
+if __name__ == "__main__":
+	parser = ArgumentParser()
+	parser.add_argument("--pair", action="append", default=[],
+		help="<tracker class>:<tracker name>")
+	parser.add_argument("--exe", default="main")
+	opts, args = parser.parse_known_args()
+
+	print("%-20s %-16s %14s %14s %8s" % ("class", "tracker", "runtime", "static", "delta"))
+	for pair in opts.pair:
+		cls, name = pair.split(":")
+		dyn = throughput(BIN + "/" + opts.exe, args, name)
+		sta = throughput(BIN + "/" + cls + "/" + opts.exe, args, name)
+		delta = 100.0 * (sta - dyn) / dyn if dyn else 0.0
+		print("%-20s %-16s %14d %14d %+7.2f%%" % (cls, name, dyn, sta, delta))
+	sys.stdout.flush()
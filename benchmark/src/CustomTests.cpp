@@ -31,6 +31,7 @@ using namespace std;
 
 
 int count_retired = 0;
+int slab_alloc = 0;
 
 void DebugTest::init(GlobalTestConfig* gtc){
 	Rideable* ptr = gtc->allocRideable();
@@ -24,8 +24,12 @@ limitations under the License.
 #include "RUnorderedMap.hpp"
 #include "ROrderedMap.hpp"
 #include "RetiredMonitorable.hpp"
+#include "LatencyHistogram.hpp"
+#include "KeyDistribution.hpp"
+#include "OpTrace.hpp"
 #include <map>
 #include <random>
+#include <thread>
 template <class T>
 class MapChurnTest : public Test{
 public:
@@ -34,6 +38,8 @@ public:
 	int prop_gets, prop_replaces, prop_puts, prop_inserts, prop_removes;
 	int range;
 	int prefill;
+	OpLatency latency;
+	KeyDistribution keys;
 
 	inline T fromInt(uint64_t v);
 	
@@ -43,7 +49,9 @@ public:
 	void init(GlobalTestConfig* gtc);
 	void parInit(GlobalTestConfig* gtc, LocalTestConfig* ltc){}
 	int execute(GlobalTestConfig* gtc, LocalTestConfig* ltc);
-	void cleanup(GlobalTestConfig* gtc){}
+	void cleanup(GlobalTestConfig* gtc){
+		latency.report(gtc);
+	}
 };
 
 template <class T>
@@ -91,6 +99,8 @@ void MapChurnTest<T>::init(GlobalTestConfig* gtc){
 	if(gtc->checkEnv("prefill")){
 		prefill = atoi((gtc->getEnv("prefill")).c_str());
 	}
+	latency.init(gtc);
+	keys.init(gtc, range);
 
 	// prefill
 	int i = 0;
@@ -120,9 +130,6 @@ inline std::string MapChurnTest<std::string>::fromInt(uint64_t v){
 
 template <class T>
 int MapChurnTest<T>::MapChurnTest::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
-	struct timeval time_up = gtc->finish;
-	struct timeval now;
-	gettimeofday(&now,NULL);
 	int ops = 0;
 	uint64_t r = ltc->seed;
 	std::mt19937_64 gen_k(r);
@@ -131,33 +138,41 @@ int MapChurnTest<T>::MapChurnTest::execute(GlobalTestConfig* gtc, LocalTestConfi
 
 	//broker->threadInit(gtc,ltc);
 
-	while(timeDiff(&now,&time_up)>0){
+	while(!gtc->stop.load(std::memory_order_relaxed)){
 		// r = nextRand(r);
+		int p = gen_p()%100;
 		r = gen_k();
-		T k = this->fromInt(r%range);
+		T k = this->fromInt(keys.next(r, p>=prop_replaces && p<prop_inserts));
 		T val = k;
-
-		int p = gen_p()%100;
+		LatencyOp op;
+		auto t0 = latency.start();
 
 		if(p<prop_gets){
 			m->get(k,tid);
+			op = lat_get;
 		}
 		else if(p<prop_replaces){
 			auto old = m->replace(k,val,tid);
+			op = lat_replace;
 		}
 		else if(p<prop_puts){
 			auto old = m->put(k,val,tid);
+			op = lat_put;
 		}
 		else if(p<prop_inserts){
 			m->insert(k,val,tid);
+			op = lat_insert;
 		}
 		else{ // p<=prop_removes
 			m->remove(k,tid);
+			op = lat_remove;
 		}
+		latency.record(tid, op, t0);
 
 		ops++;
-		gettimeofday(&now,NULL);
 	}
+	if(RetiredMonitorable* rm = dynamic_cast<RetiredMonitorable*>(m))
+		rm->leave(tid);
 	return ops;
 }
 
@@ -169,8 +184,13 @@ public:
 	int prop_gets, prop_replaces, prop_puts, prop_inserts, prop_removes;
 	int range;
 	int prefill;
+	OpLatency latency;
+	KeyDistribution keys;
+	OpTrace trace;
+	T* key_table = NULL; // fromInt(0..range-1), for trace replay
 
 	inline T fromInt(uint64_t v);
+	inline void run(int op, const T& k, int tid);
 	
 	ObjRetireTest(int p_gets, int p_replaces, int p_puts, int p_inserts, int p_removes, int range, int prefill);
 	ObjRetireTest(int p_gets, int p_replaces, int p_puts, int p_inserts, int p_removes, int range):
@@ -178,7 +198,7 @@ public:
 	void init(GlobalTestConfig* gtc);
 	void parInit(GlobalTestConfig* gtc, LocalTestConfig* ltc){}
 	int execute(GlobalTestConfig* gtc, LocalTestConfig* ltc);
-	void cleanup(GlobalTestConfig* gtc){}
+	void cleanup(GlobalTestConfig* gtc);
 };
 
 template <class T>
@@ -230,8 +250,42 @@ void ObjRetireTest<T>::init(GlobalTestConfig* gtc){
 		prefill = atoi((gtc->getEnv("prefill")).c_str());
 	}
 
+	latency.init(gtc);
+	keys.init(gtc, range);
+
+	// -dtrace=gen builds the operation stream now (-dtrace_ops per
+	// thread), -dtrace=<file> maps one written by bin/tracegen.
+	// execute() then only replays it.
+	if(gtc->checkEnv("trace")){
+		std::string path = gtc->getEnv("trace");
+		if(path == "gen"){
+			uint64_t n = 1<<20;
+			if(gtc->checkEnv("trace_ops")){
+				n = atoll((gtc->getEnv("trace_ops")).c_str());
+			}
+			int mix[lat_ops] = {pg, pr, pp, pi, pv};
+			trace.generate(gtc->task_num, n, mix, keys, range);
+		}
+		else{
+			trace.load(path);
+			range = trace.range();
+		}
+		key_table = new T[range];
+		for(int i = 0; i<range; i++){
+			key_table[i] = this->fromInt(i);
+		}
+		if(gtc->verbose){
+			printf("Trace: %u threads x %lu ops, range %d\n",
+			 trace.threads(), (unsigned long)trace.ops(), range);
+		}
+	}
+
 	// add a field in records:
 	gtc->recorder->addThreadField("obj_retired", &Recorder::sumInt64s);
+	gtc->recorder->addThreadField("scan_calls", &Recorder::sumInt64s);
+	gtc->recorder->addThreadField("scan_ns_per_call", &Recorder::avgDoubles);
+	gtc->recorder->addGlobalField("reclaimer_cpu_ms");
+	gtc->recorder->addGlobalField("tracker_meta_kb");
 
 	// prefill
 	int i = 0;
@@ -259,11 +313,29 @@ inline std::string ObjRetireTest<std::string>::fromInt(uint64_t v){
 	return std::to_string(v);
 }
 
+template <class T>
+inline void ObjRetireTest<T>::run(int op, const T& k, int tid){
+	switch(op){
+	case lat_get:
+		m->get(k,tid);
+		break;
+	case lat_replace:
+		m->replace(k,k,tid);
+		break;
+	case lat_put:
+		m->put(k,k,tid);
+		break;
+	case lat_insert:
+		m->insert(k,k,tid);
+		break;
+	default: // lat_remove
+		m->remove(k,tid);
+		break;
+	}
+}
+
 template <class T>
 int ObjRetireTest<T>::ObjRetireTest::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
-	struct timeval time_up = gtc->finish;
-	struct timeval now;
-	gettimeofday(&now,NULL);
 	int ops = 0;
 	uint64_t r = ltc->seed;
 	std::mt19937_64 gen_k(r);
@@ -272,46 +344,631 @@ int ObjRetireTest<T>::ObjRetireTest::execute(GlobalTestConfig* gtc, LocalTestCon
 
 	//broker->threadInit(gtc,ltc);
 
-	while(timeDiff(&now,&time_up)>0){
-		// r = nextRand(r);
-		r = gen_k();
-		T k = this->fromInt(r%range);
-		T val = k;
+	if(trace.active()){
+		const uint64_t* stream = trace.thread_ops(tid);
+		uint64_t len = trace.ops();
+		uint64_t i = 0;
+		while(!gtc->stop.load(std::memory_order_relaxed)){
+			uint64_t e = stream[i];
+			if(++i==len){i = 0;}
+			int op = OpTrace::op(e);
+			auto t0 = latency.start();
+			run(op, key_table[OpTrace::key(e)], tid);
+			latency.record(tid, (LatencyOp)op, t0);
+			ops++;
+		}
+	}
+	else{
+		while(!gtc->stop.load(std::memory_order_relaxed)){
+			// r = nextRand(r);
+			int p = gen_p()%100;
+			r = gen_k();
+			int op;
+			if(p<prop_gets){op = lat_get;}
+			else if(p<prop_replaces){op = lat_replace;}
+			else if(p<prop_puts){op = lat_put;}
+			else if(p<prop_inserts){op = lat_insert;}
+			else{op = lat_remove;} // p<=prop_removes
+			T k = this->fromInt(keys.next(r, op==lat_put || op==lat_insert));
+			auto t0 = latency.start();
+			run(op, k, tid);
+			latency.record(tid, (LatencyOp)op, t0);
+			ops++;
+		}
+	}
+
+	RetiredMonitorable* rm_ptr = dynamic_cast<RetiredMonitorable*>(m);
+	gtc->recorder->reportThreadInfo("obj_retired", rm_ptr->report_retired(ltc->tid), ltc->tid);
+	uint64_t scans = rm_ptr->report_scan_cnt(ltc->tid);
+	gtc->recorder->reportThreadInfo("scan_calls", scans, ltc->tid);
+	gtc->recorder->reportThreadInfo("scan_ns_per_call",
+		scans ? (double)rm_ptr->report_scan_ns(ltc->tid) / scans : 0.0, ltc->tid);
+	return ops;
+}
+
+template <class T>
+void ObjRetireTest<T>::cleanup(GlobalTestConfig* gtc){
+	// CPU time of background reclaimers (-dreclaimers), kept apart
+	// from the workers' throughput.
+	RetiredMonitorable* rm_ptr = dynamic_cast<RetiredMonitorable*>(m);
+	gtc->recorder->reportGlobalInfo("reclaimer_cpu_ms",
+		(double)rm_ptr->report_reclaimer_ns() / 1000000.0);
+	// Slots, snapshots and other per-thread tracker metadata.
+	gtc->recorder->reportGlobalInfo("tracker_meta_kb",
+		(double)rm_ptr->report_meta_bytes() / 1024.0);
+	latency.report(gtc);
+}
+
+
+// Batched lookups through RUnorderedMap::multiGet, -dbatch keys per
+// call (default 16). -dmget=0 issues the same batches as plain gets,
+// for comparison. p_updates percent of the calls are a single put or
+// remove instead. ops counts keys looked up plus updates.
+template <class T>
+class MultiGetTest : public Test{
+public:
+	RUnorderedMap<T,T>* m;
+	int p_updates;
+	int range;
+	int prefill;
+	size_t batch = 16;
+	bool mget = true;
+	KeyDistribution keys;
+
+	inline T fromInt(uint64_t v);
+
+	MultiGetTest(int p_updates, int range, int prefill):
+		p_updates(p_updates), range(range), prefill(prefill){}
+	void init(GlobalTestConfig* gtc);
+	void parInit(GlobalTestConfig* gtc, LocalTestConfig* ltc){}
+	int execute(GlobalTestConfig* gtc, LocalTestConfig* ltc);
+	void cleanup(GlobalTestConfig* gtc){}
+};
+
+template <class T>
+void MultiGetTest<T>::init(GlobalTestConfig* gtc){
+	Rideable* ptr = gtc->allocRideable();
+	this->m = dynamic_cast<RUnorderedMap<T,T>*>(ptr);
+	if (!m) {
+		 errexit("MultiGetTest must be run on RUnorderedMap<T,T> type object.");
+	}
+
+	// overrides for constructor arguments
+	if(gtc->checkEnv("range")){
+		range = atoi((gtc->getEnv("range")).c_str());
+	}
+	if(gtc->checkEnv("prefill")){
+		prefill = atoi((gtc->getEnv("prefill")).c_str());
+	}
+	if(gtc->checkEnv("batch")){
+		batch = atoi((gtc->getEnv("batch")).c_str());
+		if(batch == 0){
+			errexit("MultiGetTest - batch must be positive.");
+		}
+	}
+	if(gtc->checkEnv("mget")){
+		mget = atoi((gtc->getEnv("mget")).c_str()) != 0;
+	}
+	keys.init(gtc, range);
+
+	// prefill
+	int i = 0;
+	std::mt19937_64 gen(1);
+	for(i = 0; i<prefill; i++){
+		T k = this->fromInt(gen()%range);
+		m->put(k,k,0);
+	}
+	if(gtc->verbose){
+		printf("Prefilled %d, batch %zu (%s)\n", i, batch, mget ? "multiGet" : "get");
+	}
+}
 
+template <class T>
+inline T MultiGetTest<T>::fromInt(uint64_t v){
+	return (T)v;
+}
+
+template<>
+inline std::string MultiGetTest<std::string>::fromInt(uint64_t v){
+	return std::to_string(v);
+}
+
+template <class T>
+int MultiGetTest<T>::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
+	int ops = 0;
+	uint64_t r = ltc->seed;
+	std::mt19937_64 gen_k(r);
+	std::mt19937_64 gen_p(r+1);
+	int tid = ltc->tid;
+	std::vector<T> ks(batch);
+	std::vector<optional<T>> out(batch);
+
+	while(!gtc->stop.load(std::memory_order_relaxed)){
 		int p = gen_p()%100;
+		if(p<p_updates){
+			T k = this->fromInt(keys.next(gen_k(), p%2==0));
+			if(p%2==0){
+				m->put(k,k,tid);
+			}
+			else{
+				m->remove(k,tid);
+			}
+			ops++;
+			continue;
+		}
+		for(size_t i = 0; i<batch; i++){
+			ks[i] = this->fromInt(keys.next(gen_k(), false));
+		}
+		if(mget){
+			m->multiGet(ks.data(), batch, out.data(), tid);
+		}
+		else{
+			for(size_t i = 0; i<batch; i++){
+				out[i] = m->get(ks[i], tid);
+			}
+		}
+		ops += batch;
+	}
+	if(RetiredMonitorable* rm = dynamic_cast<RetiredMonitorable*>(m))
+		rm->leave(tid);
+	return ops;
+}
 
-		if(p<prop_gets){
-			// printf("g: %lu\n", k);
-			m->get(k,tid);
+// Range scans mixed with point operations on an ROrderedMap. p_scans
+// percent of the operations are rangeQuery(k, k+scan_len-1), p_gets
+// percent are gets and the rest are split between puts and removes.
+// -dscan_len and -dscan_ratio override the scan length (in keys of the
+// key space) and the scan percentage. ops counts scans plus point
+// operations; the keys returned by the scans are reported apart as
+// scanned_keys, and per second next to point_ops_per_sec. Scans fill a
+// per-thread buffer; -dscan_map=1 uses the std::map rangeQuery instead.
+// String keys are zero-padded to one width so that their order, and so
+// every scanned interval, is the numeric one.
+template <class T>
+class RangeQueryTest : public Test{
+public:
+	ROrderedMap<T,T>* m;
+	int p_scans;
+	int p_gets;
+	int scan_len;
+	int range;
+	int prefill;
+	bool scan_map = false;
+	int key_width = 1;	// digits in the largest key, for string keys
+	KeyDistribution keys;
+	std::atomic<uint64_t> point_ops{0};
+	std::atomic<uint64_t> scanned{0};
+
+	inline T fromInt(uint64_t v);
+
+	RangeQueryTest(int p_scans, int p_gets, int scan_len, int range, int prefill):
+		p_scans(p_scans), p_gets(p_gets), scan_len(scan_len), range(range), prefill(prefill){}
+	void init(GlobalTestConfig* gtc);
+	void parInit(GlobalTestConfig* gtc, LocalTestConfig* ltc){}
+	int execute(GlobalTestConfig* gtc, LocalTestConfig* ltc);
+	void cleanup(GlobalTestConfig* gtc);
+};
+
+template <class T>
+void RangeQueryTest<T>::init(GlobalTestConfig* gtc){
+	Rideable* ptr = gtc->allocRideable();
+	this->m = dynamic_cast<ROrderedMap<T,T>*>(ptr);
+	if (!m) {
+		 errexit("RangeQueryTest must be run on ROrderedMap<T,T> type object.");
+	}
+
+	// overrides for constructor arguments
+	if(gtc->checkEnv("range")){
+		range = atoi((gtc->getEnv("range")).c_str());
+	}
+	if(gtc->checkEnv("prefill")){
+		prefill = atoi((gtc->getEnv("prefill")).c_str());
+	}
+	if(gtc->checkEnv("scan_len")){
+		scan_len = atoi((gtc->getEnv("scan_len")).c_str());
+		if(scan_len <= 0){
+			errexit("RangeQueryTest - scan_len must be positive.");
 		}
-		else if(p<prop_replaces){
-			// printf("r: %lu\n", k);
-			auto old = m->replace(k,val,tid);
+	}
+	if(gtc->checkEnv("scan_ratio")){
+		p_scans = atoi((gtc->getEnv("scan_ratio")).c_str());
+	}
+	if(gtc->checkEnv("scan_map")){
+		scan_map = atoi((gtc->getEnv("scan_map")).c_str()) != 0;
+	}
+	if(p_scans < 0 || p_scans + p_gets > 100){
+		errexit("RangeQueryTest - scan_ratio plus gets must be within 0..100.");
+	}
+	keys.init(gtc, range);
+	key_width = std::to_string((uint64_t)range + scan_len).size();
+
+	gtc->recorder->addThreadField("range_queries", &Recorder::sumInt64s);
+	gtc->recorder->addThreadField("scanned_keys", &Recorder::sumInt64s);
+	gtc->recorder->addGlobalField("point_ops_per_sec");
+	gtc->recorder->addGlobalField("scanned_keys_per_sec");
+
+	// prefill
+	int i = 0;
+	std::mt19937_64 gen(1);
+	for(i = 0; i<prefill; i++){
+		T k = this->fromInt(gen()%range);
+		m->put(k,k,0);
+	}
+	if(gtc->verbose){
+		printf("Prefilled %d, scans %d%% of %d keys\n", i, p_scans, scan_len);
+	}
+}
+
+template <class T>
+inline T RangeQueryTest<T>::fromInt(uint64_t v){
+	return (T)v;
+}
+
+template<>
+inline std::string RangeQueryTest<std::string>::fromInt(uint64_t v){
+	std::string s = std::to_string(v);
+	return s.size() < (size_t)key_width ? std::string(key_width - s.size(), '0') + s : s;
+}
+
+template <class T>
+int RangeQueryTest<T>::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
+	int ops = 0;
+	uint64_t queries = 0;
+	uint64_t found = 0;
+	uint64_t r = ltc->seed;
+	std::mt19937_64 gen_k(r);
+	std::mt19937_64 gen_p(r+1);
+	int tid = ltc->tid;
+	std::vector<std::pair<T,T>> out;
+
+	while(!gtc->stop.load(std::memory_order_relaxed)){
+		int p = gen_p()%100;
+		if(p<p_scans){
+			uint64_t k = keys.next(gen_k(), false);
+			int len = 0;
+			if(scan_map){
+				m->rangeQuery(this->fromInt(k), this->fromInt(k+scan_len-1), len, tid);
+			}
+			else{
+				len = m->rangeQuery(this->fromInt(k), this->fromInt(k+scan_len-1), out, tid);
+			}
+			found += len;
+			queries++;
 		}
-		else if(p<prop_puts){
-			// printf("p: %lu\n", k);
-			auto old = m->put(k,val,tid);
+		else if(p<p_scans+p_gets){
+			m->get(this->fromInt(keys.next(gen_k(), false)), tid);
 		}
-		else if(p<prop_inserts){
-			// std::cout<<"i: "<<k<<std::endl;
-			// printf("i: %lu\n", k);
-			m->insert(k,val,tid);
+		else if(p%2==0){
+			T k = this->fromInt(keys.next(gen_k(), true));
+			m->put(k,k,tid);
 		}
-		else{ // p<=prop_removes
-			// std::cout<<"r: "<<k<<std::endl;
-			// printf("r: %lu\n", k);
-			m->remove(k,tid);
+		else{
+			m->remove(this->fromInt(keys.next(gen_k(), false)), tid);
+		}
+		ops++;
+	}
+
+	gtc->recorder->reportThreadInfo("range_queries", queries, tid);
+	gtc->recorder->reportThreadInfo("scanned_keys", found, tid);
+	point_ops.fetch_add(ops - queries);
+	scanned.fetch_add(found);
+	if(RetiredMonitorable* rm = dynamic_cast<RetiredMonitorable*>(m))
+		rm->leave(tid);
+	return ops;
+}
+
+template <class T>
+void RangeQueryTest<T>::cleanup(GlobalTestConfig* gtc){
+	gtc->recorder->reportGlobalInfo("point_ops_per_sec",
+		(unsigned long)(point_ops.load() / gtc->interval));
+	gtc->recorder->reportGlobalInfo("scanned_keys_per_sec",
+		(unsigned long)(scanned.load() / gtc->interval));
+}
+
+
+// Worker threads that come and go during the run. Each harness thread
+// repeatedly spawns a worker that registers with the rideable's memory
+// tracker (RetiredMonitorable::register_thread), runs churn_ops
+// operations (p_gets percent gets, the rest puts and removes) under
+// the tid it was given, unregisters and exits. -dchurn_ops overrides
+// churn_ops. threads_joined counts the workers; join_ns and leave_ns
+// are the average cost of registering and unregistering one. Workers
+// borrow pooled tids, after the harness threads' own; -dpool_threads
+// sets how many there are (default: one per harness thread).
+template <class T>
+class ThreadChurnTest : public Test{
+public:
+	RUnorderedMap<T,T>* m;
+	RetiredMonitorable* rm;
+	int p_gets;
+	int churn_ops;
+	int range;
+	int prefill;
+	KeyDistribution keys;
+
+	inline T fromInt(uint64_t v);
+
+	ThreadChurnTest(int p_gets, int churn_ops, int range, int prefill):
+		p_gets(p_gets), churn_ops(churn_ops), range(range), prefill(prefill){}
+	void init(GlobalTestConfig* gtc);
+	void parInit(GlobalTestConfig* gtc, LocalTestConfig* ltc){}
+	int execute(GlobalTestConfig* gtc, LocalTestConfig* ltc);
+	void cleanup(GlobalTestConfig* gtc){}
+};
+
+template <class T>
+void ThreadChurnTest<T>::init(GlobalTestConfig* gtc){
+	if(!gtc->checkEnv("pool_threads")){
+		gtc->setEnv("pool_threads", std::to_string(gtc->task_num));
+	}
+	Rideable* ptr = gtc->allocRideable();
+	this->m = dynamic_cast<RUnorderedMap<T,T>*>(ptr);
+	this->rm = dynamic_cast<RetiredMonitorable*>(ptr);
+	if (!m || !rm) {
+		 errexit("ThreadChurnTest must be run on RUnorderedMap<T,T> type object.");
+	}
+	int tid = rm->register_thread();
+	if (tid < 0) {
+		 errexit("ThreadChurnTest - rideable has no memory tracker or no pooled tids to register with.");
+	}
+	rm->unregister_thread(tid);
+
+	// overrides for constructor arguments
+	if(gtc->checkEnv("range")){
+		range = atoi((gtc->getEnv("range")).c_str());
+	}
+	if(gtc->checkEnv("prefill")){
+		prefill = atoi((gtc->getEnv("prefill")).c_str());
+	}
+	if(gtc->checkEnv("churn_ops")){
+		churn_ops = atoi((gtc->getEnv("churn_ops")).c_str());
+		if(churn_ops <= 0){
+			errexit("ThreadChurnTest - churn_ops must be positive.");
+		}
+	}
+	keys.init(gtc, range);
+
+	gtc->recorder->addThreadField("threads_joined", &Recorder::sumInt64s);
+	gtc->recorder->addThreadField("join_ns", &Recorder::avgDoubles);
+	gtc->recorder->addThreadField("leave_ns", &Recorder::avgDoubles);
+
+	// prefill
+	int i = 0;
+	std::mt19937_64 gen(1);
+	for(i = 0; i<prefill; i++){
+		T k = this->fromInt(gen()%range);
+		m->put(k,k,0);
+	}
+	if(gtc->verbose){
+		printf("Prefilled %d, %d ops per worker\n", i, churn_ops);
+	}
+}
+
+template <class T>
+inline T ThreadChurnTest<T>::fromInt(uint64_t v){
+	return (T)v;
+}
+
+template<>
+inline std::string ThreadChurnTest<std::string>::fromInt(uint64_t v){
+	return std::to_string(v);
+}
+
+template <class T>
+int ThreadChurnTest<T>::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
+	int ops = 0;
+	uint64_t joined = 0;
+	uint64_t join_ns = 0;
+	uint64_t leave_ns = 0;
+	uint64_t seed = ltc->seed;
+
+	while(!gtc->stop.load(std::memory_order_relaxed)){
+		std::thread worker([&](){
+			std::mt19937_64 gen_k(seed);
+			std::mt19937_64 gen_p(seed+1);
+			auto t0 = std::chrono::steady_clock::now();
+			int tid;
+			while((tid = rm->register_thread()) < 0);
+			auto t1 = std::chrono::steady_clock::now();
+			int i = 0;
+			for(; i<churn_ops && !gtc->stop.load(std::memory_order_relaxed); i++){
+				int p = gen_p()%100;
+				if(p<p_gets){
+					m->get(this->fromInt(keys.next(gen_k(), false)), tid);
+				}
+				else if(p%2==0){
+					T k = this->fromInt(keys.next(gen_k(), true));
+					m->put(k,k,tid);
+				}
+				else{
+					m->remove(this->fromInt(keys.next(gen_k(), false)), tid);
+				}
+			}
+			auto t2 = std::chrono::steady_clock::now();
+			rm->unregister_thread(tid);
+			auto t3 = std::chrono::steady_clock::now();
+			ops += i;
+			join_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+			leave_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(t3 - t2).count();
+		});
+		worker.join();
+		joined++;
+		seed += 2;
+	}
+
+	gtc->recorder->reportThreadInfo("threads_joined", joined, ltc->tid);
+	gtc->recorder->reportThreadInfo("join_ns", joined ? (double)join_ns / joined : 0.0, ltc->tid);
+	gtc->recorder->reportThreadInfo("leave_ns", joined ? (double)leave_ns / joined : 0.0, ltc->tid);
+	rm->leave(ltc->tid);
+	return ops;
+}
+
+
+// Several rideables used side by side: two instances of the -r map and
+// a queue built by queue_factory. p_gets percent of the operations are
+// gets on either map, p_moves percent move a key from one map to the
+// other, and the rest pass a key through the queue (a map remove then
+// an enqueue, or a dequeue then a map insert). With -ddomain=<name> the
+// two maps share a reclamation domain; the queue has another node type
+// and always gets its own tracker. scan_calls and
+// tracker_meta_kb count each domain once; domains reports how many
+// distinct ones the rideables use.
+template <class T>
+class CompositeTest : public Test{
+public:
+	RUnorderedMap<T,T>* maps[2];
+	RUnorderedMap<T,T>* queue;
+	std::vector<RetiredMonitorable*> rms;
+	std::vector<RetiredMonitorable*> domains;
+	RideableFactory* queue_factory;
+	int p_gets;
+	int p_moves;
+	int range;
+	int prefill;
+	KeyDistribution keys;
+
+	inline T fromInt(uint64_t v);
+
+	CompositeTest(RideableFactory* queue_factory, int p_gets, int p_moves, int range, int prefill):
+		queue_factory(queue_factory), p_gets(p_gets), p_moves(p_moves), range(range), prefill(prefill){}
+	void init(GlobalTestConfig* gtc);
+	void parInit(GlobalTestConfig* gtc, LocalTestConfig* ltc){}
+	int execute(GlobalTestConfig* gtc, LocalTestConfig* ltc);
+	void cleanup(GlobalTestConfig* gtc);
+};
+
+template <class T>
+void CompositeTest<T>::init(GlobalTestConfig* gtc){
+	Rideable* ptrs[3];
+	ptrs[0] = gtc->allocRideable();
+	ptrs[1] = gtc->allocRideable();
+	std::string domain = gtc->getEnv("domain");
+	gtc->setEnv("domain", "private");
+	ptrs[2] = queue_factory->build(gtc);
+	gtc->setEnv("domain", domain);
+	gtc->allocatedRideables.push_back(ptrs[2]);
+	for(int i = 0; i<3; i++){
+		RUnorderedMap<T,T>* m = dynamic_cast<RUnorderedMap<T,T>*>(ptrs[i]);
+		RetiredMonitorable* rm = dynamic_cast<RetiredMonitorable*>(ptrs[i]);
+		if (!m || !rm) {
+			 errexit("CompositeTest must be run on RUnorderedMap<T,T> type objects with memory trackers.");
+		}
+		if(i<2){
+			maps[i] = m;
+		}
+		else{
+			queue = m;
+		}
+		rms.push_back(rm);
+		bool seen = false;
+		for(RetiredMonitorable* d : domains){
+			seen = seen || d->report_domain() == rm->report_domain();
 		}
+		if(!seen){
+			domains.push_back(rm);
+		}
+	}
+
+	// overrides for constructor arguments
+	if(gtc->checkEnv("range")){
+		range = atoi((gtc->getEnv("range")).c_str());
+	}
+	if(gtc->checkEnv("prefill")){
+		prefill = atoi((gtc->getEnv("prefill")).c_str());
+	}
+	keys.init(gtc, range);
+
+	gtc->recorder->addThreadField("obj_retired", &Recorder::sumInt64s);
+	gtc->recorder->addThreadField("scan_calls", &Recorder::sumInt64s);
+	gtc->recorder->addGlobalField("tracker_meta_kb");
+	gtc->recorder->addGlobalField("domains");
+
+	// prefill: keys split between the maps, a tenth as many queued
+	int i = 0;
+	std::mt19937_64 gen(1);
+	for(i = 0; i<prefill; i++){
+		T k = this->fromInt(gen()%range);
+		maps[i%2]->put(k,k,0);
+	}
+	for(int j = 0; j<prefill/10; j++){
+		T k = this->fromInt(gen()%range);
+		queue->insert(k,k,0);
+	}
+	if(gtc->verbose){
+		printf("Prefilled %d, %d domains\n", i, (int)domains.size());
+	}
+}
+
+template <class T>
+inline T CompositeTest<T>::fromInt(uint64_t v){
+	return (T)v;
+}
+
+template<>
+inline std::string CompositeTest<std::string>::fromInt(uint64_t v){
+	return std::to_string(v);
+}
+
+template <class T>
+int CompositeTest<T>::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
+	int ops = 0;
+	uint64_t r = ltc->seed;
+	std::mt19937_64 gen_k(r);
+	std::mt19937_64 gen_p(r+1);
+	int tid = ltc->tid;
 
+	while(!gtc->stop.load(std::memory_order_relaxed)){
+		int p = gen_p()%100;
+		r = gen_k();
+		int a = (r>>32)&1;
+		T k = this->fromInt(keys.next(r, false));
+		if(p<p_gets){
+			maps[a]->get(k,tid);
+		}
+		else if(p<p_gets+p_moves){
+			optional<T> v = maps[a]->remove(k,tid);
+			if(v){
+				maps[1-a]->insert(k,*v,tid);
+			}
+		}
+		else if(p%2==0){
+			optional<T> v = maps[a]->remove(k,tid);
+			if(v){
+				queue->insert(k,*v,tid);
+			}
+		}
+		else{
+			optional<T> v = queue->remove(k,tid);
+			if(v){
+				maps[a]->insert(*v,*v,tid);
+			}
+		}
 		ops++;
-		gettimeofday(&now,NULL);
 	}
 
-	RetiredMonitorable* rm_ptr = dynamic_cast<RetiredMonitorable*>(m);
-	gtc->recorder->reportThreadInfo("obj_retired", rm_ptr->report_retired(ltc->tid), ltc->tid);
+	int64_t retired = 0;
+	for(RetiredMonitorable* rm : rms){
+		retired += rm->report_retired(tid);
+	}
+	uint64_t scans = 0;
+	for(RetiredMonitorable* d : domains){
+		scans += d->report_scan_cnt(tid);
+	}
+	gtc->recorder->reportThreadInfo("obj_retired", retired, tid);
+	gtc->recorder->reportThreadInfo("scan_calls", scans, tid);
 	return ops;
 }
 
+template <class T>
+void CompositeTest<T>::cleanup(GlobalTestConfig* gtc){
+	size_t meta = 0;
+	for(RetiredMonitorable* d : domains){
+		meta += d->report_meta_bytes();
+	}
+	gtc->recorder->reportGlobalInfo("tracker_meta_kb", (double)meta / 1024.0);
+	gtc->recorder->reportGlobalInfo("domains", (int)domains.size());
+}
+
 
 // by Hs: test framework used for debugging, modifiy it as needed.
 class DebugTest : public Test{
@@ -372,9 +1029,6 @@ inline int MapVerifyTest<std::string>::toInt(std::string v){
 
 template <class T>
 int MapVerifyTest<T>::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
-	struct timeval time_up = gtc->finish;
-	struct timeval now;
-	gettimeofday(&now,NULL);
 	int ops = 0;
 	uint64_t r = ltc->seed;
 	std::mt19937_64 gen_k(r);
@@ -390,8 +1044,7 @@ int MapVerifyTest<T>::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
 	uint32_t insKey = ug->initial(tid);
 	uint32_t remKey = ug->initial((tid+1)%(gtc->task_num));
 
-	while(now.tv_sec < time_up.tv_sec 
-		|| (now.tv_sec==time_up.tv_sec && now.tv_usec<time_up.tv_usec) ){
+	while(!gtc->stop.load(std::memory_order_relaxed)){
 		// r = nextRand(r);
 		r = gen_k();
 		if(gen_p()%2==0){
@@ -418,8 +1071,6 @@ int MapVerifyTest<T>::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
 			remKey = ug->next(remKey,tid);
 		}
 		ops++;
-
-		gettimeofday(&now,NULL);
 	}
 	return ops;
 }
@@ -481,9 +1132,6 @@ inline uint32_t QueryVerifyTest<std::string>::toInt(std::string v){
 
 template <class T>
 int QueryVerifyTest<T>::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
-	struct timeval time_up = gtc->finish;
-	struct timeval now;
-	gettimeofday(&now,NULL);
 	int ops = 0;
 	uint64_t r = ltc->seed;
 	std::mt19937_64 gen(r);
@@ -503,8 +1151,7 @@ int QueryVerifyTest<T>::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
 		if(curKey<leftKey) leftKey=curKey;
 		if(curKey>rightKey) rightKey=curKey;
 	}
-	while(now.tv_sec < time_up.tv_sec 
-		|| (now.tv_sec==time_up.tv_sec && now.tv_usec<time_up.tv_usec) ){
+	while(!gtc->stop.load(std::memory_order_relaxed)){
 		// r = nextRand(r);
 		r = gen();
 		if(r%2==0){
@@ -546,7 +1193,6 @@ int QueryVerifyTest<T>::execute(GlobalTestConfig* gtc, LocalTestConfig* ltc){
 			}
 		}
 		ops++;
-		gettimeofday(&now,NULL);
 	}
 	return ops;
 }
@@ -0,0 +1,162 @@
+/*
+
+Copyright 2017 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. 
+
+*/
+
+
+#ifndef KEY_DISTRIBUTION_HPP
+#define KEY_DISTRIBUTION_HPP
+
+#include <stdint.h>
+#include <math.h>
+#include <atomic>
+#include <string>
+#include "Harness.hpp"
+
+// Key distributions for the map tests, selected with
+//  -ddist=uniform  (default)
+//  -ddist=zipf     Zipfian over the key range, -dzipf=<theta> (0.99);
+//                  ranks are scattered over the range so hot keys are
+//                  not neighbours.
+//  -ddist=hotspot  -dhotops=<f> (0.8) of the operations go to the
+//                  first -dhot=<f> (0.2) of the keys.
+//  -ddist=latest   inserts and puts take increasing keys; the other
+//                  operations pick Zipf-distributed recent ones.
+// The Zipf inverse CDF is tabulated once in init(); a draw is a guide
+// table lookup plus a short forward scan.
+class KeyDistribution{
+public:
+	enum Type{dist_uniform, dist_zipf, dist_hotspot, dist_latest};
+
+private:
+	Type type = dist_uniform;
+	uint64_t range = 1;
+
+	// zipf / latest
+	double* cdf = NULL;
+	uint32_t* guide = NULL;
+	uint64_t scatter = 1;
+
+	// hotspot
+	uint64_t hot_keys = 0;
+	double hot_ops = 0.0;
+
+	// latest
+	std::atomic<uint64_t> newest;
+
+	static inline double unit(uint64_t r){
+		return (r >> 11) * (1.0 / 9007199254740992.0);
+	}
+
+	static uint64_t gcd(uint64_t a, uint64_t b){
+		while (b != 0){
+			uint64_t t = a % b;
+			a = b;
+			b = t;
+		}
+		return a;
+	}
+
+	void build_zipf(double theta){
+		cdf = new double[range];
+		guide = new uint32_t[range];
+		double sum = 0.0;
+		for (uint64_t i = 0; i < range; i++){
+			sum += 1.0 / pow((double)(i + 1), theta);
+			cdf[i] = sum;
+		}
+		for (uint64_t i = 0; i < range; i++)
+			cdf[i] /= sum;
+		cdf[range - 1] = 1.0;
+		uint64_t j = 0;
+		for (uint64_t g = 0; g < range; g++){
+			double u = (double)g / range;
+			while (cdf[j] < u) j++;
+			guide[g] = j;
+		}
+		// a multiplier coprime with range maps ranks to keys 1:1, so hot
+		// ranks land on scattered keys (it need not be odd)
+		if (range <= 2)
+			return;
+		scatter = 0x9E3779B97F4A7C15ULL % range;
+		while (scatter < 2 || gcd(scatter, range) != 1)
+			scatter++;
+	}
+
+	inline uint64_t zipf_rank(uint64_t r){
+		double u = unit(r);
+		uint64_t i = guide[(uint64_t)(u * range)];
+		while (cdf[i] < u) i++;
+		return i;
+	}
+
+public:
+	KeyDistribution(){
+		newest.store(0, std::memory_order_relaxed);
+	}
+
+	void init(GlobalTestConfig* gtc, uint64_t range){
+		init(gtc->checkEnv("dist") ? gtc->getEnv("dist") : "uniform",
+			gtc->checkEnv("zipf") ? atof(gtc->getEnv("zipf").c_str()) : 0.99,
+			gtc->checkEnv("hot") ? atof(gtc->getEnv("hot").c_str()) : 0.2,
+			gtc->checkEnv("hotops") ? atof(gtc->getEnv("hotops").c_str()) : 0.8,
+			range);
+	}
+
+	void init(const std::string& dist, double theta, double hot, double hotops, uint64_t range){
+		this->range = range;
+		if (dist == "uniform"){
+			type = dist_uniform;
+		} else if (dist == "zipf" || dist == "latest"){
+			type = (dist == "zipf") ? dist_zipf : dist_latest;
+			if (theta <= 0.0)
+				errexit("KeyDistribution - zipf parameter must be positive.");
+			if (range > UINT32_MAX)
+				errexit("KeyDistribution - range too large for zipf.");
+			build_zipf(theta);
+		} else if (dist == "hotspot"){
+			type = dist_hotspot;
+			hot_ops = hotops;
+			if (hot <= 0.0 || hot >= 1.0 || hot_ops < 0.0 || hot_ops > 1.0)
+				errexit("KeyDistribution - hotspot parameters out of range.");
+			hot_keys = (uint64_t)(hot * range);
+			if (hot_keys == 0) hot_keys = 1;
+		} else {
+			errexit("KeyDistribution - unknown dist.");
+		}
+	}
+
+	// r is a fresh 64-bit random number; insert tells whether the
+	// operation adds a key (only matters for latest).
+	inline uint64_t next(uint64_t r, bool insert){
+		switch (type){
+		case dist_zipf:
+			return (zipf_rank(r) * scatter) % range;
+		case dist_hotspot:
+			if (unit(r) < hot_ops)
+				return (r >> 3) % hot_keys;
+			return hot_keys + (r >> 3) % (range - hot_keys);
+		case dist_latest:
+			if (insert)
+				return newest.fetch_add(1, std::memory_order_relaxed) % range;
+			return (newest.load(std::memory_order_relaxed) % range + range - 1 - zipf_rank(r)) % range;
+		default:
+			return r % range;
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,158 @@
+/*
+
+Copyright 2017 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. 
+
+*/
+
+
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <stdint.h>
+#include <string.h>
+#include <malloc.h>
+#include <string>
+#include "Harness.hpp"
+
+// Log-bucketed latency histogram: 16 linear sub-buckets per power of
+// two, so a reported value is within 1/16 of the recorded one.
+class LatencyHistogram{
+	static const int SUB_BITS = 4;
+	static const int SUB = 1 << SUB_BITS;
+	static const int BUCKETS = (64 - SUB_BITS + 1) * SUB;
+
+	uint64_t counts[BUCKETS];
+	uint64_t total;
+	uint64_t max;
+
+	static inline int bucket(uint64_t v){
+		if (v < SUB) return v;
+		int shift = 63 - __builtin_clzll(v) - SUB_BITS;
+		return ((shift + 1) << SUB_BITS) + ((v >> shift) & (SUB - 1));
+	}
+	// largest value that falls into bucket b
+	static inline uint64_t upper(int b){
+		if (b < SUB) return b;
+		int shift = (b >> SUB_BITS) - 1;
+		return ((uint64_t)(SUB + (b & (SUB - 1)) + 1) << shift) - 1;
+	}
+
+public:
+	LatencyHistogram(){
+		clear();
+	}
+	void clear(){
+		memset(counts, 0, sizeof(counts));
+		total = max = 0;
+	}
+	inline void add(uint64_t v){
+		counts[bucket(v)]++;
+		total++;
+		if (v > max) max = v;
+	}
+	void merge(const LatencyHistogram& other){
+		for (int i = 0; i < BUCKETS; i++)
+			counts[i] += other.counts[i];
+		total += other.total;
+		if (other.max > max) max = other.max;
+	}
+	uint64_t count(){
+		return total;
+	}
+	uint64_t maximum(){
+		return max;
+	}
+	// q in [0,1]
+	uint64_t percentile(double q){
+		if (total == 0) return 0;
+		uint64_t target = (uint64_t)(q * total);
+		if (target < 1) target = 1;
+		uint64_t seen = 0;
+		for (int i = 0; i < BUCKETS; i++){
+			seen += counts[i];
+			if (seen >= target)
+				return upper(i) < max ? upper(i) : max;
+		}
+		return max;
+	}
+};
+
+enum LatencyOp{lat_get, lat_replace, lat_put, lat_insert, lat_remove, lat_ops};
+
+// Per-thread, per-operation latency histograms for the map tests,
+// enabled with -dlatency. The merged histograms are reported as
+// <op>_p50_ns, <op>_p99_ns, <op>_p999_ns and <op>_max_ns.
+class OpLatency{
+	struct alignas(128) ThreadHist{
+		LatencyHistogram ops[lat_ops];
+	};
+
+	ThreadHist* hists = NULL;
+	int task_num = 0;
+	double ns_per_cycle = 1.0;
+
+	static const char* name(int op){
+		static const char* names[lat_ops] = {"get", "replace", "put", "insert", "remove"};
+		return names[op];
+	}
+
+public:
+	bool enabled = false;
+
+	void init(GlobalTestConfig* gtc){
+		if (!gtc->checkEnv("latency"))
+			return;
+		enabled = true;
+		task_num = gtc->task_num + gtc->task_stall;
+		ns_per_cycle = 1.0 / gtc->cycles_per_ns;
+		hists = (ThreadHist*) memalign(alignof(ThreadHist), sizeof(ThreadHist) * task_num);
+		for (int i = 0; i < task_num; i++){
+			for (int op = 0; op < lat_ops; op++)
+				hists[i].ops[op].clear();
+		}
+		for (int op = 0; op < lat_ops; op++){
+			std::string n = name(op);
+			gtc->recorder->addGlobalField(n + "_p50_ns");
+			gtc->recorder->addGlobalField(n + "_p99_ns");
+			gtc->recorder->addGlobalField(n + "_p999_ns");
+			gtc->recorder->addGlobalField(n + "_max_ns");
+		}
+	}
+
+	inline uint64_t start(){
+		return enabled ? readCycles() : 0;
+	}
+
+	inline void record(int tid, LatencyOp op, uint64_t t0){
+		if (!enabled) return;
+		hists[tid].ops[op].add((uint64_t)((readCycles() - t0) * ns_per_cycle));
+	}
+
+	void report(GlobalTestConfig* gtc){
+		if (!enabled) return;
+		for (int op = 0; op < lat_ops; op++){
+			LatencyHistogram all;
+			for (int i = 0; i < task_num; i++)
+				all.merge(hists[i].ops[op]);
+			std::string n = name(op);
+			gtc->recorder->reportGlobalInfo(n + "_p50_ns", (unsigned long)all.percentile(0.5));
+			gtc->recorder->reportGlobalInfo(n + "_p99_ns", (unsigned long)all.percentile(0.99));
+			gtc->recorder->reportGlobalInfo(n + "_p999_ns", (unsigned long)all.percentile(0.999));
+			gtc->recorder->reportGlobalInfo(n + "_max_ns", (unsigned long)all.maximum());
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,178 @@
+/*
+
+Copyright 2017 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. 
+
+*/
+
+
+#ifndef OP_TRACE_HPP
+#define OP_TRACE_HPP
+
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <random>
+#include "Harness.hpp"
+#include "KeyDistribution.hpp"
+#include "LatencyHistogram.hpp"
+
+// Pre-generated operation streams for the map tests (-dtrace).
+// A trace holds, for each of its threads, a fixed-length sequence of
+// 64-bit entries: the operation (a LatencyOp) in the top 3 bits and
+// the key below. Traces are either generated in memory before the
+// run or loaded from a file written by bin/tracegen; either way the
+// entries live in one read-only mapping that threads index by tid
+// and replay from the start when they reach the end.
+//
+// File layout: TraceHeader, then threads*ops entries, thread-major.
+struct TraceHeader{
+	char magic[8];
+	uint32_t threads;
+	uint32_t mix[lat_ops]; // percentages, in LatencyOp order
+	uint64_t ops; // per thread
+	uint64_t range;
+};
+
+class OpTrace{
+	static constexpr const char* MAGIC = "SMRTRC01";
+
+	TraceHeader* header = NULL;
+	uint64_t* entries = NULL;
+	size_t length = 0;
+
+	static size_t file_size(uint32_t threads, uint64_t ops){
+		return sizeof(TraceHeader) + (size_t)threads * ops * sizeof(uint64_t);
+	}
+
+	void map_anonymous(size_t len){
+		void* p = mmap(NULL, len, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (p == MAP_FAILED)
+			errexit("OpTrace - mmap failed.");
+		header = (TraceHeader*) p;
+		entries = (uint64_t*) (header + 1);
+		length = len;
+	}
+
+public:
+	static const int KEY_BITS = 61;
+
+	static inline uint64_t pack(int op, uint64_t key){
+		return ((uint64_t)op << KEY_BITS) | key;
+	}
+	static inline int op(uint64_t e){
+		return (int)(e >> KEY_BITS);
+	}
+	static inline uint64_t key(uint64_t e){
+		return e & ((1ULL << KEY_BITS) - 1);
+	}
+
+	~OpTrace(){
+		if (header != NULL)
+			munmap(header, length);
+	}
+
+	bool active(){
+		return header != NULL;
+	}
+	uint32_t threads(){
+		return header->threads;
+	}
+	uint64_t ops(){
+		return header->ops;
+	}
+	uint64_t range(){
+		return header->range;
+	}
+	const uint64_t* thread_ops(int tid){
+		return entries + (size_t)(tid % header->threads) * header->ops;
+	}
+
+	// mix: percentage of each LatencyOp, summing to 100. Thread t
+	// draws with seeds derived from t only, so the same parameters
+	// always give the same trace.
+	void generate(uint32_t threads, uint64_t ops, const int mix[lat_ops],
+	 KeyDistribution& keys, uint64_t range){
+		if (range >= (1ULL << KEY_BITS))
+			errexit("OpTrace - key range too large.");
+		map_anonymous(file_size(threads, ops));
+		memcpy(header->magic, MAGIC, sizeof(header->magic));
+		header->threads = threads;
+		header->ops = ops;
+		header->range = range;
+		int cumulative[lat_ops];
+		int sum = 0;
+		for (int i = 0; i < lat_ops; i++){
+			header->mix[i] = mix[i];
+			sum += mix[i];
+			cumulative[i] = sum;
+		}
+		if (sum != 100)
+			errexit("OpTrace - operation mix must sum to 100.");
+		for (uint32_t t = 0; t < threads; t++){
+			std::mt19937_64 gen_k(2 * t + 1);
+			std::mt19937_64 gen_p(2 * t + 2);
+			uint64_t* out = entries + (size_t)t * ops;
+			for (uint64_t i = 0; i < ops; i++){
+				int p = gen_p() % 100;
+				int o = 0;
+				while (p >= cumulative[o]) o++;
+				out[i] = pack(o, keys.next(gen_k(), o == lat_put || o == lat_insert));
+			}
+		}
+	}
+
+	void write(const std::string& path){
+		int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0)
+			errexit("OpTrace - cannot create trace file.");
+		size_t len = file_size(header->threads, header->ops);
+		const char* p = (const char*) header;
+		while (len > 0){
+			ssize_t n = ::write(fd, p, len);
+			if (n <= 0)
+				errexit("OpTrace - write failed.");
+			p += n;
+			len -= n;
+		}
+		close(fd);
+	}
+
+	void load(const std::string& path){
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			errexit("OpTrace - cannot open trace file.");
+		struct stat st;
+		if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TraceHeader))
+			errexit("OpTrace - bad trace file.");
+		void* p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+		close(fd);
+		if (p == MAP_FAILED)
+			errexit("OpTrace - mmap failed.");
+		header = (TraceHeader*) p;
+		entries = (uint64_t*) (header + 1);
+		length = st.st_size;
+		if (memcmp(header->magic, MAGIC, sizeof(header->magic)) != 0
+		 || header->threads == 0 || header->ops == 0
+		 || length != file_size(header->threads, header->ops))
+			errexit("OpTrace - bad trace file.");
+		madvise(p, length, MADV_SEQUENTIAL);
+	}
+};
+
+#endif
@@ -24,6 +24,8 @@ limitations under the License.
 #include "Rideable.hpp"
 #include "RUnorderedMap.hpp"
 #include <map>
+#include <vector>
+#include <utility>
 
 
 template <class K, class V> class ROrderedMap : public virtual RUnorderedMap<K, V>{
@@ -54,8 +56,18 @@ public:
 	//end
 
 	// Get all the values between key1 and key2, inclusively. (Tentative)
-	// returns: the pointer to the first pointer of an array
-	virtual std::map<K, V> rangeQuery(K key1, K key2, int& len, int tid) = 0;
+	// Built on the overload below, one map node per pair.
+	virtual std::map<K, V> rangeQuery(K key1, K key2, int& len, int tid){
+		std::vector<std::pair<K, V>> out;
+		len = rangeQuery(key1, key2, out, tid);
+		return std::map<K, V>(out.begin(), out.end());
+	}
+
+	// Get all the pairs between key1 and key2, inclusively, into out,
+	// in key order. out is cleared first and keeps its capacity, so a
+	// buffer reused across calls stops allocating once it has grown.
+	// returns: the number of pairs in out
+	virtual int rangeQuery(K key1, K key2, std::vector<std::pair<K, V>>& out, int tid) = 0;
 	
 };
 
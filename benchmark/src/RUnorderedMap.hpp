@@ -21,6 +21,7 @@ limitations under the License.
 #define RUNORDEREDMAP_HPP
 
 #include <string>
+#include <stddef.h>
 #include "Rideable.hpp"
 
 #include "optional.hpp"
@@ -50,6 +51,15 @@ public:
 	// if the key is already present in the map
 	// returns : the replaced value, or NULL if replace was unsuccessful
 	virtual optional<V> replace(K key, V val, int tid)=0;
+
+	// Gets the values of n keys at once
+	// out[i] : the result of get(keys[i])
+	// Maps may override this to look the keys up together
+	virtual void multiGet(const K* keys, size_t n, optional<V>* out, int tid){
+		for(size_t i = 0; i<n; i++){
+			out[i] = get(keys[i], tid);
+		}
+	}
 };
 
 #endif
@@ -34,8 +34,8 @@ private:
 	BaseMT* mem_tracker = NULL;
 public:
 	RetiredMonitorable(GlobalTestConfig* gtc){
-		retired_cnt = new padded<int64_t>[gtc->task_num+gtc->task_stall];
-		for (int i=0; i<gtc->task_num+gtc->task_stall; i++){
+		retired_cnt = new padded<int64_t>[tid_count(gtc)];
+		for (int i=0; i<tid_count(gtc); i++){
 			retired_cnt[i].ui = 0;
 		}
 	}
@@ -47,12 +47,42 @@ public:
 	void collect_retired_size(int64_t size, int tid){
 		retired_cnt[tid].ui += size;
 	}
-	int64_t report_retired(int tid){
-		//calling this function at the end of the benchmark
+	// Tells the tracker that harness thread tid is done with the run.
+	void leave(int tid){
 		if (mem_tracker != NULL)
 			mem_tracker->lastExit(tid);
+	}
+	int64_t report_retired(int tid){
+		//calling this function at the end of the benchmark
+		leave(tid);
 		return retired_cnt[tid].ui;
 	}
+	uint64_t report_scan_cnt(int tid){
+		return (mem_tracker != NULL) ? mem_tracker->scanCount(tid) : 0;
+	}
+	uint64_t report_scan_ns(int tid){
+		return (mem_tracker != NULL) ? mem_tracker->scanTime(tid) : 0;
+	}
+	// Dynamic thread registration through the rideable's tracker;
+	// see BaseTracker::register_thread.
+	int register_thread(){
+		return (mem_tracker != NULL) ? mem_tracker->registerThread() : -1;
+	}
+	void unregister_thread(int tid){
+		if (mem_tracker != NULL)
+			mem_tracker->unregisterThread(tid);
+	}
+	size_t report_meta_bytes(){
+		return (mem_tracker != NULL) ? mem_tracker->metaBytes() : 0;
+	}
+	uint64_t report_reclaimer_ns(){
+		return (mem_tracker != NULL) ? mem_tracker->reclaimerTime() : 0;
+	}
+	// Rideables in one shared domain report the same tracker; tests
+	// running several rideables count its scans and metadata once.
+	const void* report_domain(){
+		return (mem_tracker != NULL) ? mem_tracker->domain() : (const void*)this;
+	}
 };
 
 #endif
@@ -33,6 +33,7 @@ limitations under the License.
 #include "rideables/LinkListStall.hpp"
 #include "rideables/CRTurnQueue.hpp"
 #include "rideables/SkipList.hpp"
+#include "rideables/SplitOrderedMap.hpp"
 
 #if (__x86_64__ || __ppc64__)
 #include "rideables/SortedUnorderedMapRange.hpp"
@@ -73,6 +74,7 @@ int main(int argc, char *argv[])
 	gtc->addRideableOption(new CRTurnQueueFactory<int,int>(), "CRTurnQueue");
 
 	gtc->addRideableOption(new SkipListFactory<int,int>(), "SkipList");
+	gtc->addRideableOption(new SplitOrderedMapFactory<int,int>(), "SplitOrderedMap");
 
 	//gtc->addRideableOption(new SortedUnorderedMapHazardFactory<int,int>(), "SortedUnorderedMapHazard");
 	// gtc->addRideableOption(new SortedUnorderedMapRCUFactory<int,int>(), "SortedUnorderedMapRCU");
@@ -101,6 +103,11 @@ int main(int argc, char *argv[])
 	gtc->addTestOption(new ObjRetireTest<int>(90,0,10,0,0,100000,50000), "ObjRetire:g90p10:range=100000:prefill=50000");
 	gtc->addTestOption(new ObjRetireTest<int>(0,0,0,50,50,100000,50000), "ObjRetire:i50rm50:range=100000:prefill=50000");
 	gtc->addTestOption(new ObjRetireTest<int>(0,0,0,50,50,65536,1024), "ObjRetire:i50rm50:range=65536:prefill=1024");
+	gtc->addTestOption(new MultiGetTest<int>(10,1000000,500000), "MultiGet:u10:range=1000000:prefill=500000");
+	gtc->addTestOption(new RangeQueryTest<int>(10,50,100,100000,50000), "RangeQuery:s10g50:len=100:range=100000:prefill=50000");
+	gtc->addTestOption(new ObjRetireTest<int>(90,0,10,0,0,2000000,1000000), "ObjRetire:g90p10:range=2000000:prefill=1000000");
+	gtc->addTestOption(new ThreadChurnTest<int>(90,1000,100000,50000), "ThreadChurn:g90:ops=1000:range=100000:prefill=50000");
+	gtc->addTestOption(new CompositeTest<int>(new CRTurnQueueFactory<int,int>(),80,10,100000,50000), "Composite:g80mv10q10:range=100000:prefill=50000");
 
 	// gtc->addTestOption(new MapOrderedGet<int>(65536, 5000), "MapOrderedGetPut:range=65536:prefill=5000");
 	// gtc->addTestOption(new MapChurnTest<int>(50,0,0,50,0,8000,1024), "MapChurn:g50i50:range=8K:prefill=1024");
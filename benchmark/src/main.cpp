@@ -32,6 +32,7 @@ limitations under the License.
 #include "rideables/LinkListStall.hpp"
 #include "rideables/CRTurnQueue.hpp"
 #include "rideables/SkipList.hpp"
+#include "rideables/SplitOrderedMap.hpp"
 
 
 #if (__x86_64__ || __ppc64__)
@@ -72,6 +73,7 @@ int main(int argc, char *argv[])
 	gtc->addRideableOption(new CRTurnQueueFactory<std::string,std::string>(), "CRTurnQueue");
 
 	gtc->addRideableOption(new SkipListFactory<std::string,std::string>(), "SkipList");
+	gtc->addRideableOption(new SplitOrderedMapFactory<std::string,std::string>(), "SplitOrderedMap");
 
 	//gtc->addRideableOption(new SortedUnorderedMapHazardFactory<std::string,std::string>(), "SortedUnorderedMapHazard");
 	// gtc->addRideableOption(new SortedUnorderedMapRCUFactory<std::string,std::string>(), "SortedUnorderedMapRCU");
@@ -102,6 +104,11 @@ int main(int argc, char *argv[])
 	gtc->addTestOption(new ObjRetireTest<string>(90,0,10,0,0,100000,50000), "ObjRetire:g90p10:range=100000:prefill=50000");
 	gtc->addTestOption(new ObjRetireTest<string>(0,0,0,50,50,100000,50000), "ObjRetire:i50rm50:range=100000:prefill=50000");
 	gtc->addTestOption(new ObjRetireTest<string>(0,0,0,50,50,65536,1024), "ObjRetire:i50rm50:range=65536:prefill=1024");
+	gtc->addTestOption(new MultiGetTest<string>(10,1000000,500000), "MultiGet:u10:range=1000000:prefill=500000");
+	gtc->addTestOption(new RangeQueryTest<string>(10,50,100,100000,50000), "RangeQuery:s10g50:len=100:range=100000:prefill=50000");
+	gtc->addTestOption(new ObjRetireTest<string>(90,0,10,0,0,2000000,1000000), "ObjRetire:g90p10:range=2000000:prefill=1000000");
+	gtc->addTestOption(new ThreadChurnTest<string>(90,1000,100000,50000), "ThreadChurn:g90:ops=1000:range=100000:prefill=50000");
+	gtc->addTestOption(new CompositeTest<string>(new CRTurnQueueFactory<std::string,std::string>(),80,10,100000,50000), "Composite:g80mv10q10:range=100000:prefill=50000");
 
 	// gtc->addTestOption(new MapOrderedGet<std::string>(65536, 5000), "MapOrderedGetPut:range=65536:prefill=5000");
 	// gtc->addTestOption(new MapChurnTest<string>(50,0,0,30,20,65536,5000), "MapChurn:g50i30rm20:range=65536:prefill=5000");
@@ -64,25 +64,17 @@ BonsaiTree<K, V>::Node::Node(BonsaiTree<K, V>::Node* l, BonsaiTree<K, V>::Node*
 	size = l_size + r_size + 1;
 }
 
-template<class K, class V>
-BonsaiTree<K, V>::Node::Node(State* state): state(state){}
-
-
-template<class K, class V>
-BonsaiTree<K, V>::Node::~Node() {
-	if(state){
-		delete state;
-	}
-}
 
 /* routines under BonsaiTree */
 template<class K, class V>
 BonsaiTree<K, V>::BonsaiTree(GlobalTestConfig* gtc): RetiredMonitorable(gtc){
 	std::string type = gtc->getEnv("tracker");
-	if (type == "Hazard" || type == "HE" || type == "WFE") errexit("Hazard, HE, and WFE not available ");
+	if (type == "Hazard" || type == "HazardSort" || type == "HE" || type == "HESort" || type == "WFE" || type == "HazardAsym" || type == "HEAsym" || type == "NBR") errexit("Hazard, HE, and WFE not available ");
 	int epochf = gtc->getEnv("epochf").empty()? 150:stoi(gtc->getEnv("epochf"));
 	int emptyf = gtc->getEnv("emptyf").empty()? 30:stoi(gtc->getEnv("emptyf"));
-	memory_tracker = new MemoryTracker<Node>(gtc, epochf, emptyf, 2, true);
+	// States live in the extra bytes of their wrapper nodes, which
+	// are freed through destroyState.
+	memory_tracker = new MemoryTracker<Node>(gtc, epochf, emptyf, 2, true, sizeof(State), true);
 	//initialize with an empty head state.
 	local_tid = 0;
 	curr_state.store(mkState());
@@ -95,8 +87,15 @@ BonsaiTree<K, V>::~BonsaiTree(){}
 /* State operations */
 template<class K, class V>
 typename BonsaiTree<K, V>::Node* BonsaiTree<K, V>::mkState(){
-	void* ptr = memory_tracker->alloc(local_tid);
-	return new (ptr) Node(new State(memory_tracker));
+	Node* state = new (memory_tracker->alloc(local_tid, sizeof(State), destroyState)) Node();
+	new (stateOf(state)) State(memory_tracker);
+	return state;
+}
+
+template<class K, class V>
+void BonsaiTree<K, V>::destroyState(BonsaiTree<K, V>::Node* state, void* extra){
+	((State*) extra)->~State();
+	state->~Node();
 }
 
 template<class K, class V>
@@ -108,13 +107,13 @@ typename BonsaiTree<K, V>::Node* BonsaiTree<K, V>::mkNode(BonsaiTree<K,V>::Node*
 	}
 	void* ptr = memory_tracker->alloc(local_tid);
 	Node* new_node = new (ptr) Node(left, right, key, value);
-	state->state->addNewNode(new_node);
+	stateOf(state)->addNewNode(new_node);
 	return new_node;
 }
 
 template<class K, class V>
 void BonsaiTree<K, V>::retireNode(BonsaiTree<K, V>::Node* state, BonsaiTree<K, V>::Node* node){
-       state->state->retire_list_prev.push_back(node);
+       stateOf(state)->retire_list_prev.push_back(node);
 }
 
 
@@ -139,7 +138,6 @@ void BonsaiTree<K, V>::reclaimState(BonsaiTree<K, V>::Node* state, std::list<Bon
 	for(; !new_list.empty(); new_list.pop_back()){
 		node = new_list.back();
 		assert(node!=retired_node);
-		assert(node->state==NULL);
 		memory_tracker->reclaim(node, local_tid);
 	}
 	memory_tracker->reclaim(state, local_tid);
@@ -169,7 +167,7 @@ bool BonsaiTree<K, V>::retiredNodeSpot(BonsaiTree<K, V>::Node* ptr){
 
 template<class K, class V>
 unsigned long BonsaiTree<K, V>::treeSize(){
-	return nodeSize(curr_state.load()->state->root);
+	return nodeSize(stateOf(curr_state.load())->root);
 }
 
 template<class K, class V>
@@ -204,24 +202,24 @@ optional<V> BonsaiTree<K, V>::update(Operation op, K key, V val, int tid){
 		new_state = mkState();
 		switch(op){
 			case op_put:
-				new_state->state->root = doPut(new_state, protect_read(old_state->state->root), key, val, &ori_val);
+				stateOf(new_state)->root = doPut(new_state, protect_read(stateOf(old_state)->root), key, val, &ori_val);
 				break;
 			case op_replace:
-				new_state->state->root = doReplace(new_state, protect_read(old_state->state->root), key, val, &ori_val);
+				stateOf(new_state)->root = doReplace(new_state, protect_read(stateOf(old_state)->root), key, val, &ori_val);
 				break;
 			case op_remove:
-				new_state->state->root = doRemove(new_state, protect_read(old_state->state->root), key, &ori_val);
+				stateOf(new_state)->root = doRemove(new_state, protect_read(stateOf(old_state)->root), key, &ori_val);
 				break;
 			case op_insert:
-				new_state->state->root = doInsert(new_state, protect_read(old_state->state->root), key, val, &ins_ret);
+				stateOf(new_state)->root = doInsert(new_state, protect_read(stateOf(old_state)->root), key, val, &ins_ret);
 				ori_val = (ins_ret)? NULL : new V();
 				break;
 			default:
 				assert(false && "operation type error.");
 		}
-		if (new_state->state->root == retired_node){
+		if (stateOf(new_state)->root == retired_node){
 			if (ori_val) delete ori_val;
-			reclaimState(new_state, new_state->state->new_list);
+			reclaimState(new_state, stateOf(new_state)->new_list);
 #ifndef LAZY_TRACKER
 			memory_tracker->end_op(tid);
 			memory_tracker->clear_all(tid);
@@ -231,7 +229,7 @@ optional<V> BonsaiTree<K, V>::update(Operation op, K key, V val, int tid){
 
 		// memory_tracker->reserve(new_state, 1, tid);
 		
-		std::list<Node*> retire_list_prev = new_state->state->retire_list_prev;
+		std::list<Node*> retire_list_prev = stateOf(new_state)->retire_list_prev;
 		if (curr_state.compare_exchange_strong(old_state, new_state, 
 			std::memory_order::memory_order_acq_rel, std::memory_order::memory_order_acquire)){
 			retireState(old_state, retire_list_prev);
@@ -241,7 +239,7 @@ optional<V> BonsaiTree<K, V>::update(Operation op, K key, V val, int tid){
 			if (ori_val) delete ori_val;
 			//memory_tracker->template destruct<State>(new_state);
 			// delete new_state;
-			reclaimState(new_state, new_state->state->new_list);
+			reclaimState(new_state, stateOf(new_state)->new_list);
 
 #ifndef LAZY_TRACKER
 			memory_tracker->end_op(tid);
@@ -285,7 +283,7 @@ optional<V> BonsaiTree<K, V>::get(K key, int tid){//TODO: new version needed.
 	collect_retired_size(memory_tracker->get_retired_cnt(tid), tid);
 	memory_tracker->start_op(tid);
 	while(true){
-		BonsaiTree<K, V>::Node* node = protect_read(protect_read(curr_state)->state->root);
+		BonsaiTree<K, V>::Node* node = protect_read(stateOf(protect_read(curr_state))->root);
 
 		while (node && node != retired_node){
 			if (node->key == key){
@@ -313,14 +311,20 @@ optional<V> BonsaiTree<K, V>::get(K key, int tid){//TODO: new version needed.
 }
 
 template<class K, class V>
-map<K, V> BonsaiTree<K,V>::rangeQuery(K key1, K key2, int& len, int tid){
-	map<K, V> ret;
+int BonsaiTree<K,V>::rangeQuery(K key1, K key2, std::vector<std::pair<K, V>>& out, int tid){
+	local_tid = tid;
+	collect_retired_size(memory_tracker->get_retired_cnt(tid), tid);
 	memory_tracker->start_op(tid);
-	BonsaiTree<K, V>::Node* root = curr_state.load()->state->root;
-	doRangeQuery(root, key1, key2, &ret);
-	memory_tracker->clear_all(tid);
+	while(true){
+		out.clear();
+		BonsaiTree<K, V>::Node* root = protect_read(stateOf(protect_read(curr_state))->root);
+		if (doRangeQuery(root, key1, key2, out)){
+			break;
+		}
+	}
 	memory_tracker->end_op(tid);
-	return ret;
+	memory_tracker->clear_all(tid);
+	return out.size();
 }
 
 template<class K, class V>
@@ -571,18 +575,26 @@ typename BonsaiTree<K, V>::Node* BonsaiTree<K, V>::doubleR(BonsaiTree<K, V>::Nod
 	return out;
 }
 
+// In-order walk of one version of the tree. Returns false when it
+// runs into a retired spot, and the caller starts over.
 template<class K, class V>
-void BonsaiTree<K,V>::doRangeQuery(Node* node, K key1, K key2, std::map<K, V>* ret){
-	// TODO: test this.
-	// if (node->value > key1 && node->left){
-	// 	doRangeQuery(node->left, key1, key2, ret);
-	// }
-	// if (node->value >= key1 && node->value <= key2){
-	// 	ret->emplace(node->key, node->value);
-	// }
-	// if (node->value < key2 && node->right){
-	// 	doRangeQuery(node->right, key1, key2, ret);
-	// }
+bool BonsaiTree<K,V>::doRangeQuery(Node* node, K key1, K key2, std::vector<std::pair<K, V>>& out){
+	if (!node){
+		return true;
+	}
+	if (node == retired_node){
+		return false;
+	}
+	if (key1 < node->key && !doRangeQuery(protect_read(node->left), key1, key2, out)){
+		return false;
+	}
+	if (!(node->key < key1) && !(key2 < node->key)){
+		out.emplace_back(node->key, node->value);
+	}
+	if (node->key < key2 && !doRangeQuery(protect_read(node->right), key1, key2, out)){
+		return false;
+	}
+	return true;
 }
 
 template class BonsaiTree<std::string, std::string>;
@@ -46,15 +46,12 @@ private:
 		K key;
 		V value;
 		unsigned long size;
-		//or a wrapper to a State node.
-		State* state = NULL;
-		Node* next_state = NULL;
+		//or a wrapper to a State node, which keeps the State
+		//in its extra bytes (see stateOf).
 		
 		Node();
 
 		Node(Node* l, Node* r, K k, V v);
-		Node(State* state);
-		~Node();
 	};
 
 
@@ -94,6 +91,10 @@ private:
 
 	Node* mkState();
 	void killNewState(Node* state);
+	static void destroyState(Node* state, void* extra);
+	State* stateOf(Node* state){
+		return (State*) memory_tracker->node_extra(state);
+	}
 	
 	Node* mkNode(State* state);
 	Node* mkNode(Node* state, Node* left, Node* right, K key, V value);
@@ -113,7 +114,7 @@ private:
 	Node* pullRightMost(Node* state, Node* node, Node** successor);
 
 	//routine for rangeQuery
-	void doRangeQuery(Node* node, K key1, K key2, std::map<K, V>* ret);
+	bool doRangeQuery(Node* node, K key1, K key2, std::vector<std::pair<K, V>>& out);
 
 	//garbage collection:
 	void retireNode(Node* state, Node* node);
@@ -139,7 +140,8 @@ public:
 	bool insert(K key, V val, int tid);
 	optional<V> remove(K key, int tid);
 	optional<V> replace(K key, V val, int tid);
-	std::map<K, V> rangeQuery(K key1, K key2, int& len, int tid);
+	using ROrderedMap<K, V>::rangeQuery;
+	int rangeQuery(K key1, K key2, std::vector<std::pair<K, V>>& out, int tid);
 };
 
 
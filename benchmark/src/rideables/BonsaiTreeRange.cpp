@@ -307,13 +307,18 @@ optional<V> BonsaiTreeRange<K, V>::get(K key, int tid){//TODO: new version neede
 }
 
 template<class K, class V>
-map<K, V> BonsaiTreeRange<K,V>::rangeQuery(K key1, K key2, int& len, int tid){//TODO: new version needed.
-	map<K, V> ret;
+int BonsaiTreeRange<K,V>::rangeQuery(K key1, K key2, std::vector<std::pair<K, V>>& out, int tid){
+	collect_retired_size(range_tracker->get_retired_cnt(tid), tid);
 	range_tracker->reserve(tid);
-	BonsaiTreeRange<K, V>::Node* root = curr_state->state->root.ptr();
-	doRangeQuery(root, key1, key2, &ret);
+	while(true){
+		out.clear();
+		BonsaiTreeRange<K, V>::Node* root = protect_read(protect_read(curr_state)->state->root);
+		if (doRangeQuery(root, key1, key2, out)){
+			break;
+		}
+	}
 	range_tracker->clear(tid);
-	return ret;
+	return out.size();
 }
 
 template<class K, class V>
@@ -563,18 +568,26 @@ typename BonsaiTreeRange<K, V>::Node* BonsaiTreeRange<K, V>::doubleR(BonsaiTreeR
 }
 
 
+// In-order walk of one version of the tree. Returns false when it
+// runs into a retired spot, and the caller starts over.
 template<class K, class V>
-void BonsaiTreeRange<K,V>::doRangeQuery(Node* node, K key1, K key2, std::map<K, V>* ret){
-	//TODO: test this.
-	/*if (node->value > key1 && node->left){
-		doRangeQuery(node->left, key1, key2, ret);
+bool BonsaiTreeRange<K,V>::doRangeQuery(Node* node, K key1, K key2, std::vector<std::pair<K, V>>& out){
+	if (!node){
+		return true;
+	}
+	if (node == retired_node){
+		return false;
+	}
+	if (key1 < node->key && !doRangeQuery(protect_read(node->left), key1, key2, out)){
+		return false;
+	}
+	if (!(node->key < key1) && !(key2 < node->key)){
+		out.emplace_back(node->key, node->value);
 	}
-	if (node->value >= key1 && node->value <= key2){
-		ret->emplace(node->key, node->value);
+	if (node->key < key2 && !doRangeQuery(protect_read(node->right), key1, key2, out)){
+		return false;
 	}
-	if (node->value < key2 && node->right){
-		doRangeQuery(node->right, key1, key2, ret);
-	}*/
+	return true;
 }
 
 template class BonsaiTreeRange<std::string, std::string>;
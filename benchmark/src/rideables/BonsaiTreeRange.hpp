@@ -113,7 +113,7 @@ private:
 	Node* pullRightMost(Node* state, Node* node, Node** successor);
 
 	//routine for rangeQuery
-	void doRangeQuery(Node* node, K key1, K key2, std::map<K, V>* ret);
+	bool doRangeQuery(Node* node, K key1, K key2, std::vector<std::pair<K, V>>& out);
 
 	//garbage collection:
 	void retireNode(Node* state, Node* node);
@@ -139,7 +139,8 @@ public:
 	bool insert(K key, V val, int tid);
 	optional<V> remove(K key, int tid);
 	optional<V> replace(K key, V val, int tid);
-	std::map<K, V> rangeQuery(K key1, K key2, int& len, int tid);
+	using ROrderedMap<K, V>::rangeQuery;
+	int rangeQuery(K key1, K key2, std::vector<std::pair<K, V>>& out, int tid);
 };
 
 
@@ -69,7 +69,6 @@ private:
     };
 
     static const int IDX_NONE = -1;
-    static const int MAX_THREADS = 128;
     const int maxThreads;
 
     MemoryTracker<Node>* memory_tracker;
@@ -80,11 +79,11 @@ private:
     // Pointers to head and tail of the list
     alignas(128) std::atomic<Node*> head;
     alignas(128) std::atomic<Node*> tail;
-    // Enqueue requests
-    alignas(128) std::atomic<Node*> enqueuers[MAX_THREADS];
-    // Dequeue requests
-    alignas(128) std::atomic<Node*> deqself[MAX_THREADS];
-    alignas(128) std::atomic<Node*> deqhelp[MAX_THREADS];
+    // Enqueue requests, one entry per thread
+    alignas(128) std::atomic<Node*>* enqueuers;
+    // Dequeue requests, one entry per thread
+    std::atomic<Node*>* deqself;
+    std::atomic<Node*>* deqhelp;
 
     // To make sure we are not affected by the misaligned object
     alignas(128) int __pad2;
@@ -158,7 +157,7 @@ private:
 
 public:
    CRTurnQueue(GlobalTestConfig* gtc):
-           RetiredMonitorable(gtc),maxThreads(gtc->task_num) {
+           RetiredMonitorable(gtc),maxThreads(tid_count(gtc)) {
         int epochf = gtc->getEnv("epochf").empty()? 150:stoi(gtc->getEnv("epochf"));
         int emptyf = gtc->getEnv("emptyf").empty()? 30:stoi(gtc->getEnv("emptyf"));
         std::cout<<"emptyf:"<<emptyf<<std::endl;
@@ -167,6 +166,9 @@ public:
         sentinelNode = mkNode(0);
         head.store(sentinelNode, std::memory_order_relaxed);
         tail.store(sentinelNode, std::memory_order_relaxed);
+        enqueuers = (std::atomic<Node*>*) memalign(128, sizeof(std::atomic<Node*>) * maxThreads);
+        deqself = (std::atomic<Node*>*) memalign(128, sizeof(std::atomic<Node*>) * maxThreads);
+        deqhelp = (std::atomic<Node*>*) memalign(128, sizeof(std::atomic<Node*>) * maxThreads);
         for (int i = 0; i < maxThreads; i++) {
             enqueuers[i].store(nullptr, std::memory_order_relaxed);
             // deqself[i] != deqhelp[i] means that isRequest=false
@@ -187,6 +189,9 @@ public:
         for (int i=0; i < maxThreads; i++) memory_tracker->reclaim(deqhelp[i].load(), 0);
 	memory_tracker->end_op(0);
         memory_tracker->clear_all(0);
+        free(enqueuers);
+        free(deqself);
+        free(deqhelp);
     }
 
     Node* mkNode(int tid){
@@ -92,6 +92,9 @@ private:
 	Node* r;
 	Node* s;
 	padded<SeekRecord>* records;
+	// rangeQuery holds two reservations for the whole recursion, so it
+	// is only safe when start_op protects every node (epochs, Hyaline)
+	bool scan_safe;
 	const size_t GET_POINTER_BITS = 0xfffffffffffffffc;//for machine 64-bit or less.
 
 	/* helper functions */
@@ -141,7 +144,7 @@ private:
 	/* private interfaces */
 	void seek(K key, int tid);
 	bool cleanup(K key, int tid);
-	void doRangeQuery(Node& k1, Node& k2, int tid, Node* root, std::map<K,V>& res);
+	void doRangeQuery(Node& k1, Node& k2, int tid, Node* root, std::vector<std::pair<K,V>>& res);
 public:
 	NatarajanTree(GlobalTestConfig* gtc): RetiredMonitorable(gtc)
 	//memory_tracker("HE",gtc->task_num,150,200,5,COLLECT)
@@ -151,13 +154,17 @@ public:
         int epochf = gtc->getEnv("epochf").empty()? 150:stoi(gtc->getEnv("epochf"));
         int emptyf = gtc->getEnv("emptyf").empty()? 30:stoi(gtc->getEnv("emptyf"));
 		memory_tracker = new MemoryTracker<Node>(gtc, epochf, emptyf, 5, COLLECT);
+		std::string type = gtc->getEnv("tracker");
+		scan_safe = !(type == "Hazard" || type == "HazardSort" || type == "HazardAsym" ||
+			type == "HE" || type == "HESort" || type == "HEAsym" || type == "WFE" ||
+			type == "HR" || type == "HRAsym" || type == "WFR" || type == "NBR");
 		r = Node::alloc(infK,defltV,nullptr,nullptr,2,memory_tracker,0);
 		s = Node::alloc(infK,defltV,nullptr,nullptr,1,memory_tracker,0);
 		r->right = Node::alloc(infK,defltV,nullptr,nullptr,2,memory_tracker,0);
 		r->left = s;
 		s->right = Node::alloc(infK,defltV,nullptr,nullptr,1,memory_tracker,0);
 		s->left = Node::alloc(infK,defltV,nullptr,nullptr,0,memory_tracker,0);
-		records = new padded<SeekRecord>[gtc->task_num+gtc->task_stall]{};
+		records = new padded<SeekRecord>[tid_count(gtc)]{};
 		this->setBaseMT(memory_tracker);
 	};
 	~NatarajanTree(){};
@@ -167,7 +174,8 @@ public:
 	bool insert(K key, V val, int tid);
 	optional<V> remove(K key, int tid);
 	optional<V> replace(K key, V val, int tid);
-	std::map<K, V> rangeQuery(K key1, K key2, int& len, int tid);
+	using ROrderedMap<K,V>::rangeQuery;
+	int rangeQuery(K key1, K key2, std::vector<std::pair<K,V>>& out, int tid);
 };
 
 template <class K, class V> 
@@ -183,6 +191,7 @@ void NatarajanTree<K,V>::seek(K key, int tid){
 	/* initialize the seek record using sentinel nodes */
 	Node keyNode{key,defltV,nullptr,nullptr};//node to be compared
 	SeekRecord* seekRecord=&(records[tid].ui);
+	TRACKER_READ_PHASE(memory_tracker, tid);
 	seekRecord->ancestor=r;
 	seekRecord->successor=memory_tracker->read(r->left,1,tid,r);
 	seekRecord->parent=memory_tracker->read(r->left,2,tid,r);
@@ -223,7 +232,9 @@ void NatarajanTree<K,V>::seek(K key, int tid){
 		}
 		current=getPtr(currentField);
 	}
-	/* traversal complete */
+	/* traversal complete; the caller works on the seek record */
+	memory_tracker->end_read(tid, seekRecord->ancestor, seekRecord->successor,
+		seekRecord->parent, seekRecord->leaf);
 	return;
 }
 
@@ -588,9 +599,10 @@ optional<V> NatarajanTree<K,V>::replace(K key, V val, int tid){
 }
 
 template <class K, class V>
-std::map<K, V> NatarajanTree<K,V>::rangeQuery(K key1, K key2, int& len, int tid){
-	//NOT HP-like GC safe.
-	if(key1>key2) return {};
+int NatarajanTree<K,V>::rangeQuery(K key1, K key2, std::vector<std::pair<K,V>>& out, int tid){
+	if(!scan_safe) errexit("NatarajanTree::rangeQuery - not available with Hazard, HE, HR, WFE, WFR or NBR.");
+	out.clear();
+	if(key1>key2) return 0;
 	Node k1{key1,defltV,nullptr,nullptr};//node to be compared
 	Node k2{key2,defltV,nullptr,nullptr};//node to be compared
 
@@ -600,22 +612,21 @@ std::map<K, V> NatarajanTree<K,V>::rangeQuery(K key1, K key2, int& len, int tid)
 	Node* leaf=getPtr(memory_tracker->read(s->left,0,tid,s));
 	Node* current=getPtr(memory_tracker->read(leaf->left,1,tid,leaf));
 
-	std::map<K,V> res;
 	if(current!=nullptr)
-		doRangeQuery(k1,k2,tid,current,res);
-	len=res.size();
+		doRangeQuery(k1,k2,tid,current,out);
+	memory_tracker->clear_all(tid);
 	memory_tracker->end_op(tid);
-	return res;
+	return out.size();
 }
 
 template <class K, class V>
-void NatarajanTree<K,V>::doRangeQuery(Node& k1, Node& k2, int tid, Node* root, std::map<K,V>& res){
+void NatarajanTree<K,V>::doRangeQuery(Node& k1, Node& k2, int tid, Node* root, std::vector<std::pair<K,V>>& res){
 	Node* left=getPtr(memory_tracker->read(root->left,2,tid,root));
 	Node* right=getPtr(memory_tracker->read(root->right,3,tid,root));
 	if(left==nullptr&&right==nullptr){
 		if(nodeLessEqual(&k1,root)&&nodeLessEqual(root,&k2)){
 			
-			res.emplace(root->key,root->val);
+			res.emplace_back(root->key,root->val);
 		}
 		return;
 	}
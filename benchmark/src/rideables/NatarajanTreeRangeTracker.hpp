@@ -146,7 +146,7 @@ private:
 	/* private interfaces */
 	void seek(K key, int tid);
 	bool cleanup(K key, int tid);
-	void doRangeQuery(Node& k1, Node& k2, int tid, Node* root, std::map<K,V>& res);
+	void doRangeQuery(Node& k1, Node& k2, int tid, Node* root, std::vector<std::pair<K,V>>& res);
 public:
 	NatarajanTreeRangeTracker(GlobalTestConfig* gtc): RetiredMonitorable(gtc)
 	{//TODO: finish range_tracker initialization.
@@ -168,7 +168,8 @@ public:
 	bool insert(K key, V val, int tid);
 	optional<V> remove(K key, int tid);
 	optional<V> replace(K key, V val, int tid);
-	std::map<K, V> rangeQuery(K key1, K key2, int& len, int tid);
+	using ROrderedMap<K,V>::rangeQuery;
+	int rangeQuery(K key1, K key2, std::vector<std::pair<K,V>>& out, int tid);
 };
 
 template <class K, class V> 
@@ -585,9 +586,10 @@ optional<V> NatarajanTreeRangeTracker<K,V>::replace(K key, V val, int tid){
 }
 
 template <class K, class V>
-std::map<K, V> NatarajanTreeRangeTracker<K,V>::rangeQuery(K key1, K key2, int& len, int tid){
+int NatarajanTreeRangeTracker<K,V>::rangeQuery(K key1, K key2, std::vector<std::pair<K,V>>& out, int tid){
 	//NOT HP-like GC safe.
-	if(key1>key2) return {};
+	out.clear();
+	if(key1>key2) return 0;
 	Node k1{key1,defltV,nullptr,nullptr};//node to be compared
 	Node k2{key2,defltV,nullptr,nullptr};//node to be compared
 
@@ -597,22 +599,20 @@ std::map<K, V> NatarajanTreeRangeTracker<K,V>::rangeQuery(K key1, K key2, int& l
 	Node* leaf=getPtr(range_tracker->read(s->left));
 	Node* current=getPtr(range_tracker->read(leaf->left));
 
-	std::map<K,V> res;
 	if(current!=nullptr)
-		doRangeQuery(k1,k2,tid,current,res);
-	len=res.size();
+		doRangeQuery(k1,k2,tid,current,out);
 	range_tracker->clear(tid);
-	return res;
+	return out.size();
 }
 
 template <class K, class V>
-void NatarajanTreeRangeTracker<K,V>::doRangeQuery(Node& k1, Node& k2, int tid, Node* root, std::map<K,V>& res){
+void NatarajanTreeRangeTracker<K,V>::doRangeQuery(Node& k1, Node& k2, int tid, Node* root, std::vector<std::pair<K,V>>& res){
 	Node* left=getPtr(range_tracker->read(root->left));
 	Node* right=getPtr(range_tracker->read(root->right));
 	if(left==nullptr&&right==nullptr){
 		if(nodeLessEqual(&k1,root)&&nodeLessEqual(root,&k2)){
 			
-			res.emplace(root->key,root->val);
+			res.emplace_back(root->key,root->val);
 		}
 		return;
 	}
@@ -9,8 +9,9 @@
 #include "MemoryTracker.hpp"
 #include "RetiredMonitorable.hpp"
 
-// 6 levels at most for now
-#define SL_MAX_LEVEL 5 // (number + 1) * 2 + 1 must fit in the number of HP/HE/WFE/HE/WFR indices
+// 32 levels; find() reuses the same 3 HP/HE/WFE/HR/WFR indices at every level
+#define SL_MAX_LEVEL 31
+#define SL_SLOTS 3
 
 #ifdef NGC
 #define COLLECT false
@@ -18,16 +19,16 @@
 #define COLLECT true
 #endif
 
-template <class K, class V> class SkipList : public RUnorderedMap<K, V>, public RetiredMonitorable {
+template <class K, class V> class SkipList : public ROrderedMap<K, V>, public RetiredMonitorable {
 private:
 
+	// The tower lives in the same block, after the tracker's header
 	struct Node {
-		Node(const K &_key, const V &_value, size_t _topLevel)
-		  : key(_key), value(_value), topLevel(_topLevel), refcnt(_topLevel+1) {
-			next = new std::atomic<Node*>[topLevel+1];
-		}
-		~Node() {
-			delete [] next;
+		Node(const K &_key, const V &_value, size_t _topLevel, void *tower)
+		  : key(_key), value(_value), topLevel(_topLevel), refcnt(_topLevel+1),
+		    next((std::atomic<Node*> *) tower) {
+			for (size_t i = 0; i <= topLevel; i++)
+				new (&next[i]) std::atomic<Node*>(nullptr);
 		}
 		K key;
 		V value;
@@ -39,46 +40,54 @@ private:
 	Node* head;
 
 	MemoryTracker<Node>* memory_tracker;
-	std::mt19937_64 gen;
+	padded<std::mt19937_64>* gens;
 
 	inline Node *alloc_node(int tid) {
-		void *ptr = memory_tracker->alloc(tid);
-		return new (ptr) Node({}, {}, SL_MAX_LEVEL);
+		return alloc_node(tid, {}, {}, SL_MAX_LEVEL);
+	}
+
+	// Geometric tower heights, p = 1/2
+	inline size_t random_level(int tid) {
+		return __builtin_ctzll(gens[tid].ui() | (1ULL << SL_MAX_LEVEL));
 	}
 
 	inline Node *alloc_node(int tid, const K &key, const V &value,
 			size_t height) {
-		void *ptr = memory_tracker->alloc(tid);
-		return new (ptr) Node(key, value, height);
+		Node *ptr = (Node *) memory_tracker->alloc(tid,
+			(height + 1) * sizeof(std::atomic<Node*>));
+		return new (ptr) Node(key, value, height, memory_tracker->node_extra(ptr));
 	}
 
 public:
-	SkipList(GlobalTestConfig* gtc) : RetiredMonitorable(gtc), gen(1) {
+	SkipList(GlobalTestConfig* gtc) : RetiredMonitorable(gtc) {
 		int epochf = gtc->getEnv("epochf").empty()? 150:stoi(gtc->getEnv("epochf"));
 		int emptyf = gtc->getEnv("emptyf").empty()? 30:stoi(gtc->getEnv("emptyf"));
-		memory_tracker = new MemoryTracker<Node>(gtc, epochf, emptyf, (SL_MAX_LEVEL + 1) * 2 + 1, COLLECT);
+		memory_tracker = new MemoryTracker<Node>(gtc, epochf, emptyf, SL_SLOTS, COLLECT,
+			(SL_MAX_LEVEL + 1) * sizeof(std::atomic<Node*>));
 		this->setBaseMT(memory_tracker);
+		gens = new padded<std::mt19937_64>[tid_count(gtc)];
+		for (int i = 0; i < tid_count(gtc); i++)
+			gens[i].ui.seed(i + 1);
 		head = alloc_node(0);
-		for (size_t i = 0; i <= SL_MAX_LEVEL; i++) {
-			head->next[i].store(nullptr, std::memory_order_relaxed);
-		}
 	}
 
 	~SkipList() { }
 
-	bool find(const K &key, int tid, Node **preds, Node **succs)
+	// Searches down to level stop. Index 0 holds pred and 1 holds curr
+	// when moving one level down, so only preds[stop] and succs[stop]
+	// stay protected; the entries above are hints for new towers and
+	// must not be dereferenced.
+	bool find(const K &key, int tid, Node **preds, Node **succs, size_t stop = 0)
 	{
-		int idx;
 		Node *pred, *curr, *succ;
 
 		retry:
 		pred = head;
-		idx = 0;
-		for (ssize_t l = SL_MAX_LEVEL; l >= 0; l--) {
-			curr = memory_tracker->read(pred->next[l], idx+1, tid, pred);
+		for (ssize_t l = SL_MAX_LEVEL; l >= (ssize_t) stop; l--) {
+			curr = memory_tracker->read(pred->next[l], 1, tid, pred);
 			if ((size_t) curr & 0x1UL) goto retry;
 			while (curr) {
-				succ = memory_tracker->read(curr->next[l], idx+2, tid, curr);
+				succ = memory_tracker->read(curr->next[l], 2, tid, curr);
 				while ((size_t) succ & 0x1UL) {
 					succ = (Node *) ((size_t) succ & ~0x1UL);
 					if (!pred->next[l].compare_exchange_strong(curr, succ))
@@ -86,21 +95,20 @@ public:
 					if (curr->refcnt.fetch_sub(1) == 1)
 						memory_tracker->retire(curr, tid);
 					curr = succ;
-					memory_tracker->transfer(idx+2, idx+1, tid);
+					memory_tracker->transfer(2, 1, tid);
 					if (!curr)
 						break;
-					succ = memory_tracker->read(curr->next[l], idx+2, tid, curr);
+					succ = memory_tracker->read(curr->next[l], 2, tid, curr);
 				}
 				if (!curr || curr->key >= key)
 					break;
 				pred = curr;
-				memory_tracker->transfer(idx+1, idx, tid);
+				memory_tracker->transfer(1, 0, tid);
 				curr = succ;
-				memory_tracker->transfer(idx+2, idx+1, tid);
+				memory_tracker->transfer(2, 1, tid);
 			}
 			preds[l] = pred;
 			succs[l] = curr;
-			idx += 2;
 		}
 		return curr && curr->key == key;
 	}
@@ -126,7 +134,7 @@ public:
 		optional<V> res={};
 		bool isPresent;
 		Node *preds[SL_MAX_LEVEL+1], *succs[SL_MAX_LEVEL+1];
-		size_t topLevel = gen() % (SL_MAX_LEVEL + 1);
+		size_t topLevel = random_level(tid);
 
 		collect_retired_size(memory_tracker->get_retired_cnt(tid), tid);
 		memory_tracker->start_op(tid);
@@ -174,6 +182,9 @@ public:
 
 		for (size_t l = 1; l <= topLevel; l++) {
 			while (1) {
+				// preds[l] is not protected anymore, search it again;
+				// a removed newNode has next[l] marked by now
+				find(key, tid, preds, succs, l);
 				pred = preds[l];
 				succ = succs[l];
 				Node *expected = newNode->next[l].load();
@@ -189,13 +200,6 @@ public:
 				}
 				if (pred->next[l].compare_exchange_strong(succ, newNode))
 					break;
-				if (!find(key, tid, preds, succs) || succs[0] != newNode) {
-					// The node is already in the process of deletion,
-					// roll back
-					if (newNode->refcnt.fetch_sub(topLevel + 1 - l) == topLevel + 1 - l)
-						memory_tracker->retire(newNode, tid);
-					goto done;
-				}
 			}
 		}
 
@@ -209,7 +213,7 @@ done:
 	{
 		bool res = false;
 		Node *preds[SL_MAX_LEVEL+1], *succs[SL_MAX_LEVEL+1];
-		size_t topLevel = gen() % (SL_MAX_LEVEL + 1);
+		size_t topLevel = random_level(tid);
 
 		collect_retired_size(memory_tracker->get_retired_cnt(tid), tid);
 		memory_tracker->start_op(tid);
@@ -229,6 +233,9 @@ done:
 
 		for (size_t l = 1; l <= topLevel; l++) {
 			while (1) {
+				// preds[l] is not protected anymore, search it again;
+				// a removed newNode has next[l] marked by now
+				find(key, tid, preds, succs, l);
 				pred = preds[l];
 				succ = succs[l];
 				Node *expected = newNode->next[l].load();
@@ -244,13 +251,6 @@ done:
 				}
 				if (pred->next[l].compare_exchange_strong(succ, newNode))
 					break;
-				if (!find(key, tid, preds, succs) || succs[0] != newNode) {
-					// The node is already in the process of deletion,
-					// roll back
-					if (newNode->refcnt.fetch_sub(topLevel + 1 - l) == topLevel + 1 - l)
-						memory_tracker->retire(newNode, tid);
-					goto done;
-				}
 			}
 		}
 
@@ -303,6 +303,44 @@ done:
 		optional<V> res={};
 		return res;
 	}
+
+	using ROrderedMap<K, V>::rangeQuery;
+
+	int rangeQuery(K key1, K key2, std::vector<std::pair<K, V>>& out, int tid)
+	{
+		Node *preds[SL_MAX_LEVEL+1], *succs[SL_MAX_LEVEL+1];
+		Node *curr, *succ;
+		K from = key1;
+		// find() leaves succs[0] in index 1
+		const int idx = 1;
+
+		collect_retired_size(memory_tracker->get_retired_cnt(tid), tid);
+		memory_tracker->start_op(tid);
+		out.clear();
+
+		retry:
+		find(from, tid, preds, succs);
+		curr = succs[0];
+		while (curr && curr->key <= key2) {
+			succ = memory_tracker->read(curr->next[0], idx+1, tid, curr);
+			if ((size_t) succ & 0x1UL) {
+				// curr is being deleted and its successor may
+				// already be gone, let find() unlink it first
+				from = curr->key;
+				goto retry;
+			}
+			// put() links the new node before it unlinks the one it
+			// replaces, so a retry can meet an emitted key again
+			if (out.empty() || out.back().first != curr->key)
+				out.emplace_back(curr->key, curr->value);
+			curr = succ;
+			memory_tracker->transfer(idx+1, idx, tid);
+		}
+
+		memory_tracker->end_op(tid);
+		memory_tracker->clear_all(tid);
+		return out.size();
+	}
 };
 
 template <class K, class V> class SkipListFactory : public RideableFactory{
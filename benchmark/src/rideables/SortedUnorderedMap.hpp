@@ -38,6 +38,9 @@ limitations under the License.
 #define COLLECT true
 #endif
 
+// keys looked up together by multiGet
+#define MGET_GROUP 8
+
 template <class K, class V>
 class SortedUnorderedMap : public RUnorderedMap<K,V>, public RetiredMonitorable{
 	struct Node;
@@ -62,6 +65,9 @@ private:
 	bool findNode(MarkPtr* &prev, Node* &cur, Node* &nxt, K key, int tid);
 	
 	MemoryTracker<Node>* memory_tracker;
+	// multiGet walks a group of lists side by side, which needs every
+	// node protected by start_op alone (epochs, Hyaline)
+	bool interleave;
 
 	const size_t GET_POINTER_BITS = 0xfffffffffffffffe;
 	inline Node* getPtr(Node* mptr){
@@ -85,6 +91,10 @@ public:
 		std::cout<<"emptyf:"<<emptyf<<std::endl;
 		memory_tracker = new MemoryTracker<Node>(gtc, epochf, emptyf, 3, COLLECT);
 		this->setBaseMT(memory_tracker);
+		std::string type = gtc->getEnv("tracker");
+		interleave = !(type == "Hazard" || type == "HazardSort" || type == "HazardAsym" ||
+			type == "HE" || type == "HESort" || type == "HEAsym" || type == "WFE" ||
+			type == "HR" || type == "HRAsym" || type == "WFR" || type == "NBR");
 	}
 	~SortedUnorderedMap(){};
 
@@ -99,6 +109,7 @@ public:
 	bool insert(K key, V val, int tid);
 	optional<V> remove(K key, int tid);
 	optional<V> replace(K key, V val, int tid);
+	void multiGet(const K* keys, size_t n, optional<V>* out, int tid);
 };
 
 template <class K, class V> 
@@ -127,6 +138,88 @@ optional<V> SortedUnorderedMap<K,V>::get(K key, int tid) {
 	return res;
 }
 
+// One reservation for the whole batch. Keys are taken MGET_GROUP at a
+// time and their bucket slots are prefetched together.
+// With interleave, each key of the group keeps its own position and
+// every round moves each of them one hop, prefetching the node it will
+// look at next, so the misses of the whole walk overlap. Marked nodes
+// are stepped over, not unlinked, as the walk holds no reservations.
+// Otherwise (HP-style trackers) only the first nodes are prefetched,
+// without protection (a prefetch of freed memory does not fault), and
+// the lists are walked one by one with the usual findNode.
+template <class K, class V> 
+void SortedUnorderedMap<K,V>::multiGet(const K* keys, size_t n, optional<V>* out, int tid) {
+	MarkPtr* prev=nullptr;
+	Node* cur=nullptr;
+	Node* nxt=nullptr;
+	size_t idx[MGET_GROUP];
+	Node* pos[MGET_GROUP];
+
+	collect_retired_size(memory_tracker->get_retired_cnt(tid), tid);
+
+	memory_tracker->start_op(tid);
+	if(interleave){
+		for(size_t base=0; base<n; base+=MGET_GROUP){
+			size_t m = (n-base<MGET_GROUP)? n-base : MGET_GROUP;
+			size_t live=0;
+			for(size_t i=0; i<m; i++){
+				idx[i]=hash_fn(keys[base+i])%idxSize;
+				__builtin_prefetch(&bucket[idx[i]].ui);
+			}
+			for(size_t i=0; i<m; i++){
+				out[base+i]={};
+				pos[i]=getPtr(memory_tracker->read(bucket[idx[i]].ui.ptr, 0, tid, nullptr));
+				if(pos[i]!=nullptr){
+					__builtin_prefetch(pos[i]);
+					live++;
+				}
+			}
+			while(live>0){
+				for(size_t i=0; i<m; i++){
+					if(pos[i]==nullptr)
+						continue;
+					Node* c=pos[i];
+					Node* nx=memory_tracker->read(c->next.ptr, 0, tid, c);
+					if(!getMk(nx) && c->key>=keys[base+i]){
+						if(c->key==keys[base+i])
+							out[base+i]=c->val;
+						pos[i]=nullptr;
+						live--;
+						continue;
+					}
+					pos[i]=getPtr(nx);
+					if(pos[i]!=nullptr)
+						__builtin_prefetch(pos[i]);
+					else
+						live--;
+				}
+			}
+		}
+	}
+	else{
+		for(size_t base=0; base<n; base+=MGET_GROUP){
+			size_t m = (n-base<MGET_GROUP)? n-base : MGET_GROUP;
+			for(size_t i=0; i<m; i++){
+				idx[i]=hash_fn(keys[base+i])%idxSize;
+				__builtin_prefetch(&bucket[idx[i]].ui);
+			}
+			for(size_t i=0; i<m; i++){
+				__builtin_prefetch(getPtr(bucket[idx[i]].ui.ptr.load(std::memory_order_relaxed)));
+			}
+			for(size_t i=0; i<m; i++){
+				if(findNode(prev,cur,nxt,keys[base+i],tid)){
+					out[base+i]=cur->val;
+				}
+				else{
+					out[base+i]={};
+				}
+			}
+		}
+	}
+	memory_tracker->clear_all(tid);
+	memory_tracker->end_op(tid);
+}
+
 template <class K, class V> 
 optional<V> SortedUnorderedMap<K,V>::put(K key, V val, int tid) {
 	Node* tmpNode = nullptr;
@@ -271,6 +364,8 @@ optional<V> SortedUnorderedMap<K,V>::replace(K key, V val, int tid) {
 template <class K, class V> 
 bool SortedUnorderedMap<K,V>::findNode(MarkPtr* &prev, Node* &cur, Node* &nxt, K key, int tid){
 	while(true){
+		// returns with prevBlock, cur and nxt reserved for the caller
+		TRACKER_READ_PHASE(memory_tracker, tid);
 		size_t idx=hash_fn(key)%idxSize;
 		bool cmark=false;
 		Node *prevBlock = nullptr;
@@ -279,25 +374,35 @@ bool SortedUnorderedMap<K,V>::findNode(MarkPtr* &prev, Node* &cur, Node* &nxt, K
 		cur=getPtr(memory_tracker->read(prev->ptr, 1, tid, prevBlock));
 
 		while(true){//to lock old and cur
-			if(cur==nullptr) return false;
+			if(cur==nullptr){
+				memory_tracker->end_read(tid, prevBlock, cur, nxt);
+				return false;
+			}
 			nxt=memory_tracker->read(cur->next.ptr, 0, tid, cur);
 			cmark=getMk(nxt);
 			nxt=getPtr(nxt);
 			if(mixPtrMk(nxt,cmark)!=memory_tracker->read(cur->next.ptr, 1, tid, cur))
 				break;//return findNode(prev,cur,nxt,key,tid);
-			auto ckey=cur->key;
 			if(memory_tracker->read(prev->ptr, 2, tid, prevBlock)!=cur)
 				break;//return findNode(prev,cur,nxt,key,tid);
+			// cur is reserved in slot 2 now; no copy of the key, since a
+			// neutralized read phase would skip its destructor
+			const K& ckey=cur->key;
 			if(!cmark){
-				if(ckey>=key) return ckey==key;
+				if(ckey>=key){
+					memory_tracker->end_read(tid, prevBlock, cur, nxt);
+					return ckey==key;
+				}
 				prev=&(cur->next);
 				prevBlock = cur;
 			}
 			else{
+				memory_tracker->end_read(tid, prevBlock, cur, nxt);
 				if(prev->ptr.compare_exchange_strong(cur,nxt,std::memory_order_acq_rel))
 					memory_tracker->retire(cur, tid);
 				else
 					break;//return findNode(prev,cur,nxt,key,tid);
+				memory_tracker->begin_read(tid);
 			}
 			cur=nxt;
 		}
@@ -0,0 +1,453 @@
+/*
+
+Copyright 2017 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. 
+
+*/
+
+
+#ifndef SPLIT_ORDERED_MAP
+#define SPLIT_ORDERED_MAP
+
+#include <atomic>
+#include "Harness.hpp"
+#include "ConcurrentPrimitives.hpp"
+#include "RUnorderedMap.hpp"
+#include "MemoryTracker.hpp"
+#include "RetiredMonitorable.hpp"
+#include <functional>
+#include <stdio.h>
+#include <stdlib.h>
+#include <iostream>
+
+#ifdef NGC
+#define COLLECT false
+#else
+#define COLLECT true
+#endif
+
+// A resizable lock-free hash map according to Shalev and Shavit[2006]
+// (split-ordered lists). All nodes live in one Michael[2002] sorted
+// list ordered by bit-reversed hash; each bucket points to a sentinel
+// node in that list. The table doubles when the average bucket holds
+// more than SO_LOAD_FACTOR keys, and new buckets are initialized lazily
+// on first use, so growth never moves nodes. Buckets are held in
+// segments of doubling size, allocated on demand.
+//
+// Sentinels are never removed. Regular nodes are read, retired and
+// reclaimed through MemoryTracker exactly as in SortedUnorderedMap.
+#define SO_LOAD_FACTOR		2
+#define SO_MAX_SEGMENTS		41 // up to 2^40 buckets
+#define SO_COUNT_BATCH		32
+
+template <class K, class V>
+class SplitOrderedMap : public RUnorderedMap<K,V>, public RetiredMonitorable{
+	struct Node;
+
+	struct MarkPtr{
+		std::atomic<Node*> ptr;
+		MarkPtr(Node* n):ptr(n){};
+		MarkPtr():ptr(nullptr){};
+	};
+
+	struct Node{
+		uint64_t so_key;
+		K key;
+		V val;
+		MarkPtr next;
+		Node(){};
+		Node(uint64_t s, K k, V v, Node* n):so_key(s),key(k),val(v),next(n){};
+	};
+private:
+	std::hash<K> hash_fn;
+	std::atomic<std::atomic<Node*>*> segments[SO_MAX_SEGMENTS];
+	std::atomic<uint64_t> size; // number of buckets in use, a power of 2
+	std::atomic<int64_t> count;
+	padded<int64_t>* count_delta;
+	bool findNode(Node* head, MarkPtr* &prev, Node* &cur, Node* &nxt,
+		uint64_t so, const K& key, bool sentinel, int tid);
+	
+	MemoryTracker<Node>* memory_tracker;
+
+	const size_t GET_POINTER_BITS = 0xfffffffffffffffe;
+	inline Node* getPtr(Node* mptr){
+		return (Node*) ((size_t)mptr & GET_POINTER_BITS);
+	}
+	inline bool getMk(Node* mptr){
+		return (bool)((size_t)mptr & 1);
+	}
+	inline Node* mixPtrMk(Node* ptr, bool mk){
+		return (Node*) ((size_t)ptr | mk);
+	}
+	inline Node* setMk(Node* mptr){
+		return mixPtrMk(mptr,true);
+	}
+
+	static inline uint64_t reverse(uint64_t v){
+		v = ((v >> 1) & 0x5555555555555555ULL) | ((v & 0x5555555555555555ULL) << 1);
+		v = ((v >> 2) & 0x3333333333333333ULL) | ((v & 0x3333333333333333ULL) << 2);
+		v = ((v >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((v & 0x0F0F0F0F0F0F0F0FULL) << 4);
+		return __builtin_bswap64(v);
+	}
+	inline uint64_t hashOf(const K& key){
+		return (uint64_t)hash_fn(key) & ~(1ULL << 63);
+	}
+	// regular keys are odd, sentinel keys even
+	static inline uint64_t regularKey(uint64_t h){
+		return reverse(h | (1ULL << 63));
+	}
+	static inline uint64_t sentinelKey(uint64_t b){
+		return reverse(b);
+	}
+	// order of cur relative to (so, key)
+	inline int compare(Node* cur, uint64_t so, const K& key, bool sentinel){
+		if(cur->so_key != so) return cur->so_key < so ? -1 : 1;
+		if(sentinel) return 0;
+		return cur->key < key ? -1 : (cur->key == key ? 0 : 1);
+	}
+
+	// bucket b lives in segment 64-clz(b) (0 for b=0), which holds
+	// buckets [2^(s-1), 2^s)
+	static inline int segmentOf(uint64_t b){
+		return b == 0 ? 0 : 64 - __builtin_clzll(b);
+	}
+	static inline uint64_t segmentBase(int s){
+		return s == 0 ? 0 : 1ULL << (s - 1);
+	}
+	static inline uint64_t segmentSize(int s){
+		return s == 0 ? 1 : 1ULL << (s - 1);
+	}
+	std::atomic<Node*>* segment(int s){
+		std::atomic<Node*>* seg = segments[s].load(std::memory_order_acquire);
+		if(seg == nullptr){
+			std::atomic<Node*>* fresh = new std::atomic<Node*>[segmentSize(s)];
+			for(uint64_t i = 0; i < segmentSize(s); i++)
+				fresh[i].store(nullptr, std::memory_order_relaxed);
+			if(segments[s].compare_exchange_strong(seg, fresh, std::memory_order_acq_rel))
+				seg = fresh;
+			else
+				delete[] fresh;
+		}
+		return seg;
+	}
+	inline std::atomic<Node*>& bucket(uint64_t b){
+		int s = segmentOf(b);
+		return segment(s)[b - segmentBase(s)];
+	}
+
+	Node* initBucket(uint64_t b, int tid);
+	inline Node* bucketHead(uint64_t h, int tid){
+		uint64_t b = h & (size.load(std::memory_order_acquire) - 1);
+		Node* head = bucket(b).load(std::memory_order_acquire);
+		return head ? head : initBucket(b, tid);
+	}
+	void addCount(int64_t d, int tid);
+
+public:
+	SplitOrderedMap(GlobalTestConfig* gtc, uint64_t initial_size):
+		RetiredMonitorable(gtc){
+        int epochf = gtc->getEnv("epochf").empty()? 150:stoi(gtc->getEnv("epochf"));
+        int emptyf = gtc->getEnv("emptyf").empty()? 30:stoi(gtc->getEnv("emptyf"));
+		std::cout<<"emptyf:"<<emptyf<<std::endl;
+		memory_tracker = new MemoryTracker<Node>(gtc, epochf, emptyf, 3, COLLECT);
+		this->setBaseMT(memory_tracker);
+
+		uint64_t s = 2;
+		while(s < initial_size) s <<= 1;
+		size.store(s, std::memory_order_relaxed);
+		count.store(0, std::memory_order_relaxed);
+		count_delta = new padded<int64_t>[tid_count(gtc)];
+		for(int i = 0; i < tid_count(gtc); i++)
+			count_delta[i].ui = 0;
+		for(int i = 0; i < SO_MAX_SEGMENTS; i++)
+			segments[i].store(nullptr, std::memory_order_relaxed);
+		// bucket 0's sentinel heads the whole list
+		bucket(0).store(mkNode(sentinelKey(0), K(), V(), nullptr, 0), std::memory_order_release);
+	}
+	~SplitOrderedMap(){};
+
+	Node* mkNode(uint64_t s, K k, V v, Node* n, int tid){
+		void* ptr = memory_tracker->alloc(tid);
+		return new (ptr) Node(s, k, v, n);
+	}
+
+
+	optional<V> get(K key, int tid);
+	optional<V> put(K key, V val, int tid);
+	bool insert(K key, V val, int tid);
+	optional<V> remove(K key, int tid);
+	optional<V> replace(K key, V val, int tid);
+};
+
+template <class K, class V> 
+class SplitOrderedMapFactory : public RideableFactory{
+	SplitOrderedMap<K,V>* build(GlobalTestConfig* gtc){
+		return new SplitOrderedMap<K,V>(gtc,1024);
+	}
+};
+
+//-------Definition----------
+template <class K, class V> 
+typename SplitOrderedMap<K,V>::Node* SplitOrderedMap<K,V>::initBucket(uint64_t b, int tid){
+	// the parent bucket precedes b in split order
+	uint64_t parent = b & ~(1ULL << (63 - __builtin_clzll(b)));
+	Node* phead = bucket(parent).load(std::memory_order_acquire);
+	if(phead == nullptr)
+		phead = initBucket(parent, tid);
+
+	uint64_t so = sentinelKey(b);
+	Node* sentinel = mkNode(so, K(), V(), nullptr, tid);
+	MarkPtr* prev=nullptr;
+	Node* cur=nullptr;
+	Node* nxt=nullptr;
+	while(true){
+		if(findNode(phead,prev,cur,nxt,so,K(),true,tid)){
+			memory_tracker->reclaim(sentinel, tid);
+			sentinel = cur;
+			break;
+		}
+		sentinel->next.ptr.store(cur,std::memory_order_release);
+		if(prev->ptr.compare_exchange_strong(cur,sentinel,std::memory_order_acq_rel))
+			break;
+	}
+	Node* expected = nullptr;
+	bucket(b).compare_exchange_strong(expected, sentinel, std::memory_order_acq_rel);
+	return sentinel;
+}
+
+template <class K, class V> 
+void SplitOrderedMap<K,V>::addCount(int64_t d, int tid){
+	int64_t delta = (count_delta[tid].ui += d);
+	if(delta < SO_COUNT_BATCH && delta > -SO_COUNT_BATCH)
+		return;
+	count_delta[tid].ui = 0;
+	int64_t c = count.fetch_add(delta, std::memory_order_relaxed) + delta;
+	uint64_t s = size.load(std::memory_order_relaxed);
+	if(c > (int64_t)(s * SO_LOAD_FACTOR) && s < (1ULL << (SO_MAX_SEGMENTS - 1)))
+		size.compare_exchange_strong(s, s * 2, std::memory_order_acq_rel);
+}
+
+template <class K, class V> 
+optional<V> SplitOrderedMap<K,V>::get(K key, int tid) {
+	MarkPtr* prev=nullptr;
+	Node* cur=nullptr;
+	Node* nxt=nullptr;
+	optional<V> res={};
+	uint64_t h = hashOf(key);
+
+	collect_retired_size(memory_tracker->get_retired_cnt(tid), tid);
+
+	memory_tracker->start_op(tid);
+	if(findNode(bucketHead(h,tid),prev,cur,nxt,regularKey(h),key,false,tid)){
+		res=cur->val;
+	}
+	memory_tracker->clear_all(tid);
+	memory_tracker->end_op(tid);
+	return res;
+}
+
+template <class K, class V> 
+optional<V> SplitOrderedMap<K,V>::put(K key, V val, int tid) {
+	Node* tmpNode = nullptr;
+	MarkPtr* prev=nullptr;
+	Node* cur=nullptr;
+	Node* nxt=nullptr;
+	optional<V> res={};
+	uint64_t h = hashOf(key);
+	uint64_t so = regularKey(h);
+	tmpNode = mkNode(so, key, val, nullptr, tid);
+
+	collect_retired_size(memory_tracker->get_retired_cnt(tid), tid);
+
+	memory_tracker->start_op(tid);
+	Node* head = bucketHead(h,tid);
+	while(true){
+		if(findNode(head,prev,cur,nxt,so,key,false,tid)){
+			res=cur->val;
+			tmpNode->next.ptr.store(cur,std::memory_order_release);
+			if(prev->ptr.compare_exchange_strong(cur,tmpNode,std::memory_order_acq_rel)){
+				while(!cur->next.ptr.compare_exchange_strong(nxt,setMk(nxt),std::memory_order_acq_rel));//mark cur
+				if(tmpNode->next.ptr.compare_exchange_strong(cur,nxt,std::memory_order_acq_rel)){
+					memory_tracker->retire(cur, tid);
+				}
+				else{
+					findNode(head,prev,cur,nxt,so,key,false,tid);
+				}
+				break;
+			}
+		}
+		else{//does not exist, insert.
+			res={};
+			tmpNode->next.ptr.store(cur,std::memory_order_release);
+			if(prev->ptr.compare_exchange_strong(cur,tmpNode,std::memory_order_acq_rel)){
+				break;
+			}
+		}
+	}
+	memory_tracker->end_op(tid);
+	memory_tracker->clear_all(tid);
+	if(!res.has_value())
+		addCount(1, tid);
+	return res;
+}
+
+template <class K, class V> 
+bool SplitOrderedMap<K,V>::insert(K key, V val, int tid){
+	Node* tmpNode = nullptr;
+	MarkPtr* prev=nullptr;
+	Node* cur=nullptr;
+	Node* nxt=nullptr;
+	bool res=false;
+	uint64_t h = hashOf(key);
+	uint64_t so = regularKey(h);
+	tmpNode = mkNode(so, key, val, nullptr, tid);
+
+	collect_retired_size(memory_tracker->get_retired_cnt(tid), tid);
+
+	memory_tracker->start_op(tid);
+	Node* head = bucketHead(h,tid);
+	while(true){
+		if(findNode(head,prev,cur,nxt,so,key,false,tid)){
+			res=false;
+			memory_tracker->reclaim(tmpNode, tid);
+			break;
+		}
+		else{//does not exist, insert.
+			tmpNode->next.ptr.store(cur,std::memory_order_release);
+			if(prev->ptr.compare_exchange_strong(cur,tmpNode,std::memory_order_acq_rel)){
+				res=true;
+				break;
+			}
+		}
+	}
+	memory_tracker->end_op(tid);
+	memory_tracker->clear_all(tid);
+	if(res)
+		addCount(1, tid);
+	return res;
+}
+
+template <class K, class V> 
+optional<V> SplitOrderedMap<K,V>::remove(K key, int tid) {
+	MarkPtr* prev=nullptr;
+	Node* cur=nullptr;
+	Node* nxt=nullptr;
+	optional<V> res={};
+	uint64_t h = hashOf(key);
+	uint64_t so = regularKey(h);
+
+	collect_retired_size(memory_tracker->get_retired_cnt(tid), tid);
+
+	memory_tracker->start_op(tid);
+	Node* head = bucketHead(h,tid);
+	while(true){
+		if(!findNode(head,prev,cur,nxt,so,key,false,tid)){
+			res={};
+			break;
+		}
+		res=cur->val;
+		if(!cur->next.ptr.compare_exchange_strong(nxt,setMk(nxt),std::memory_order_acq_rel))
+			continue;
+		if(prev->ptr.compare_exchange_strong(cur,nxt,std::memory_order_acq_rel)){
+			memory_tracker->retire(cur, tid);
+		}
+		else{
+			findNode(head,prev,cur,nxt,so,key,false,tid);
+		}
+		break;
+	}
+	memory_tracker->end_op(tid);
+	memory_tracker->clear_all(tid);
+	if(res.has_value())
+		addCount(-1, tid);
+	return res;
+}
+
+template <class K, class V> 
+optional<V> SplitOrderedMap<K,V>::replace(K key, V val, int tid) {
+	Node* tmpNode = nullptr;
+	MarkPtr* prev=nullptr;
+	Node* cur=nullptr;
+	Node* nxt=nullptr;
+	optional<V> res={};
+	uint64_t h = hashOf(key);
+	uint64_t so = regularKey(h);
+	tmpNode = mkNode(so, key, val, nullptr, tid);
+
+	collect_retired_size(memory_tracker->get_retired_cnt(tid), tid);
+
+	memory_tracker->start_op(tid);
+	Node* head = bucketHead(h,tid);
+	while(true){
+		if(findNode(head,prev,cur,nxt,so,key,false,tid)){
+			res=cur->val;
+			tmpNode->next.ptr.store(cur,std::memory_order_release);
+			if(prev->ptr.compare_exchange_strong(cur,tmpNode,std::memory_order_acq_rel)){
+				while(!cur->next.ptr.compare_exchange_strong(nxt,setMk(nxt),std::memory_order_acq_rel));//mark cur
+				if(tmpNode->next.ptr.compare_exchange_strong(cur,nxt,std::memory_order_acq_rel)){
+					memory_tracker->retire(cur, tid);
+				}
+				else{
+					findNode(head,prev,cur,nxt,so,key,false,tid);
+				}
+				break;
+			}
+		}
+		else{//does not exist
+			res={};
+			memory_tracker->reclaim(tmpNode, tid);
+			break;
+		}
+	}
+	memory_tracker->end_op(tid);
+	memory_tracker->clear_all(tid);
+	return res;
+}
+
+template <class K, class V> 
+bool SplitOrderedMap<K,V>::findNode(Node* head, MarkPtr* &prev, Node* &cur, Node* &nxt,
+ uint64_t so, const K& key, bool sentinel, int tid){
+	while(true){
+		bool cmark=false;
+		Node *prevBlock = head;
+		prev=&head->next;
+
+		cur=getPtr(memory_tracker->read(prev->ptr, 1, tid, prevBlock));
+
+		while(true){//to lock old and cur
+			if(cur==nullptr) return false;
+			nxt=memory_tracker->read(cur->next.ptr, 0, tid, cur);
+			cmark=getMk(nxt);
+			nxt=getPtr(nxt);
+			if(mixPtrMk(nxt,cmark)!=memory_tracker->read(cur->next.ptr, 1, tid, cur))
+				break;
+			int c=compare(cur,so,key,sentinel);
+			if(memory_tracker->read(prev->ptr, 2, tid, prevBlock)!=cur)
+				break;
+			if(!cmark){
+				if(c>=0) return c==0;
+				prev=&(cur->next);
+				prevBlock = cur;
+			}
+			else{
+				if(prev->ptr.compare_exchange_strong(cur,nxt,std::memory_order_acq_rel))
+					memory_tracker->retire(cur, tid);
+				else
+					break;
+			}
+			cur=nxt;
+		}
+	}
+}
+#endif
@@ -0,0 +1,106 @@
+/*
+
+Copyright 2017 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. 
+
+*/
+
+
+// Writes an operation trace for ObjRetireTest (-dtrace=<file>).
+// e.g. bin/tracegen -o g50i30rm20.trace -t 8 -n 1000000 -k 65536 \
+//        -m 50,0,0,30,20 -d dist=zipf -d zipf=0.99
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <map>
+#include <string>
+
+#include "Harness.hpp"
+#include "KeyDistribution.hpp"
+#include "OpTrace.hpp"
+
+using namespace std;
+
+static void usage(const char* name){
+	fprintf(stderr, "usage: %s -o <trace_file> [-t <threads>] [-n <ops_per_thread>] "
+		"[-k <key_range>] [-m <get,replace,put,insert,remove percentages>] "
+		"[-d dist|zipf|hot|hotops=<value>] [-h]\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+	string out;
+	uint32_t threads = 4;
+	uint64_t ops = 1<<20;
+	uint64_t range = 65536;
+	int mix[lat_ops] = {50, 0, 0, 30, 20};
+	map<string,string> env;
+	env["dist"] = "uniform";
+	env["zipf"] = "0.99";
+	env["hot"] = "0.2";
+	env["hotops"] = "0.8";
+
+	int c;
+	while ((c = getopt(argc, argv, "o:t:n:k:m:d:h")) != -1){
+		switch (c){
+		case 'o':
+			out = optarg;
+			break;
+		case 't':
+			threads = atoi(optarg);
+			break;
+		case 'n':
+			ops = atoll(optarg);
+			break;
+		case 'k':
+			range = atoll(optarg);
+			break;
+		case 'm':
+			if (sscanf(optarg, "%d,%d,%d,%d,%d", &mix[lat_get], &mix[lat_replace],
+			 &mix[lat_put], &mix[lat_insert], &mix[lat_remove]) != lat_ops){
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'd': {
+			string kv = optarg;
+			size_t eq = kv.find('=');
+			if (eq == string::npos || env.count(kv.substr(0, eq)) == 0){
+				usage(argv[0]);
+				return 1;
+			}
+			env[kv.substr(0, eq)] = kv.substr(eq + 1);
+			break;
+		}
+		default:
+			usage(argv[0]);
+			return c == 'h' ? 0 : 1;
+		}
+	}
+	if (out.empty() || threads == 0 || ops == 0 || range == 0){
+		usage(argv[0]);
+		return 1;
+	}
+
+	KeyDistribution keys;
+	keys.init(env["dist"], atof(env["zipf"].c_str()), atof(env["hot"].c_str()),
+		atof(env["hotops"].c_str()), range);
+	OpTrace trace;
+	trace.generate(threads, ops, mix, keys, range);
+	trace.write(out);
+	printf("Wrote %u threads x %lu ops (range %lu) to %s\n",
+		threads, (unsigned long)ops, (unsigned long)range, out.c_str());
+	return 0;
+}
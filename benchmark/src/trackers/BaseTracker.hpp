@@ -25,20 +25,145 @@ limitations under the License.
 #include <list>
 #include <vector>
 #include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <unistd.h>
+#include <setjmp.h>
+#include <sys/syscall.h>
+#include <linux/membarrier.h>
 #include "ConcurrentPrimitives.hpp"
 #include "RAllocator.hpp"
+#include "NodePool.hpp"
+#include "Reclaimer.hpp"
+
+// cap on a thread's pending nodes, in units of the per-op budget
+#define PENDING_OPS	64
 
 extern int count_retired;
 
+// How a tracker checks retired nodes against reservations:
+// one by one against every slot, or against a sorted snapshot.
+enum ScanType{scan_linear, scan_sorted};
+
+// How a tracker publishes reservations: with seq_cst stores, or
+// (fence_asym) with release stores followed by a compiler barrier,
+// which the reclaimer upgrades to full fences on every running
+// thread with membarrier() before it scans.
+enum FenceType{fence_seq_cst, fence_asym};
+
+inline void asym_fence_init(){
+	if (syscall(__NR_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0) != 0)
+		errexit("asym_fence_init - membarrier is not supported.");
+}
+inline void asym_light_fence(){
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+inline void asym_heavy_fence(){
+	syscall(__NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0);
+}
+
+// Per-thread rows of reservation slots, sized at construction time.
+// Each row starts on its own 128-byte boundary, like the padded
+// fixed-size slot arrays this replaces.
+template<class E> class SlotArray{
+private:
+	char* base = NULL;
+	size_t stride = 0;
+	int rows = 0;
+public:
+	void init(int rows, int cols){
+		this->rows = rows;
+		stride = (sizeof(E) * cols + 127) & ~(size_t)127;
+		base = (char*) memalign(128, stride * rows);
+	}
+	size_t bytes() const{
+		return stride * rows;
+	}
+	inline E* operator[](int row) const{
+		return (E*) (base + row * stride);
+	}
+};
+
 template<class T> class BaseTracker{
+public:
+	// Destroys a node of a typed tracker; extra is node_extra(obj).
+	typedef void (*Deleter)(T* obj, void* extra);
 private:
 	int task_num;
+	padded<uint64_t>* scan_cnt;
+	padded<uint64_t>* scan_ns;
+	padded<std::atomic<bool>>* tid_used;
+	int first_pooled;	// tids from here up are lent by register_thread
+	size_t meta_bytes = 0;
+	NodePool* node_pool = NULL;
+	size_t node_size = 0;
+	size_t max_extra = 0;
+	size_t prefix = 0;
+	static thread_local size_t alloc_extra;
+	Reclaimer<T>* reclaimer = NULL;
+
+	struct alignas(128) Pending {
+		T* head;
+		size_t count;
+	};
+	Pending* pending = NULL;
+	size_t free_budget = 0;
+
+	void drain(Pending* p, size_t budget){
+		while (p->head != NULL && budget-- > 0){
+			T* obj = p->head;
+			p->head = *(T**)(obj + 1);
+			p->count--;
+			reclaim(obj);
+		}
+	}
 public:
 	paddedAtomic<unsigned long> *retired;
 
+	virtual ~BaseTracker(){
+		delete reclaimer;
+	}
+
 	BaseTracker(int task_num):task_num(task_num){
 		retired = new paddedAtomic<unsigned long>;
 		retired->ui.store(0, std::memory_order_seq_cst);
+		scan_cnt = new padded<uint64_t>[task_num];
+		scan_ns = new padded<uint64_t>[task_num];
+		tid_used = new padded<std::atomic<bool>>[task_num];
+		first_pooled = task_num;
+		for (int i = 0; i < task_num; i++){
+			scan_cnt[i].ui = 0;
+			scan_ns[i].ui = 0;
+			tid_used[i].ui.store(false, std::memory_order_relaxed);
+		}
+	}
+
+	// Dynamic thread registration, for threads that come and go (e.g.
+	// in a thread pool) instead of holding a harness tid for the whole
+	// run. A registering thread borrows a free tid of the pooled range
+	// (first..task_num-1, after the harness and stalled threads' tids),
+	// or gets -1 if all are taken. Per-tid state (retired lists,
+	// batches, counters) stays with the tid and is taken over by its
+	// next owner.
+	void init_pooled_tids(int first){
+		first_pooled = first;
+	}
+	int register_thread(){
+		for (int i = first_pooled; i < task_num; i++){
+			bool exp = false;
+			if (!tid_used[i].ui.load(std::memory_order_relaxed) &&
+				tid_used[i].ui.compare_exchange_strong(exp, true, std::memory_order_acq_rel))
+				return i;
+		}
+		return -1;
+	}
+	// Returns false if tid was not borrowed (or was already given back).
+	bool unregister_thread(int tid){
+		if (!tid_used[tid].ui.load(std::memory_order_acquire))
+			return false;
+		thread_exit(tid);
+		tid_used[tid].ui.store(false, std::memory_order_release);
+		return true;
 	}
 
 	virtual int64_t get_retired_cnt(int tid){
@@ -57,18 +182,196 @@ public:
 			retired->ui.fetch_sub(1, std::memory_order_relaxed);
 	}
 
+	// Time spent in reclamation scans, for trackers that record it.
+	void add_scan_time(std::chrono::steady_clock::time_point start, int tid){
+		scan_cnt[tid].ui++;
+		scan_ns[tid].ui += std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - start).count();
+	}
+	uint64_t get_scan_cnt(int tid){
+		return scan_cnt[tid].ui;
+	}
+	uint64_t get_scan_ns(int tid){
+		return scan_ns[tid].ui;
+	}
+
+	// Bytes of per-thread slots, snapshots and other tracker metadata
+	// allocated at construction (not counting nodes), for trackers
+	// that record it.
+	void add_meta_bytes(size_t bytes){
+		meta_bytes += bytes;
+	}
+	size_t get_meta_bytes(){
+		return meta_bytes;
+	}
+
+	// Node memory: T plus the tracker's header. Comes from a per-thread
+	// NodePool with -dalloc=slab, and from malloc otherwise. Trackers
+	// give the size here; build_node_pool() makes the pool once
+	// init_node_extra() and init_typed() have fixed the block size.
+	void init_node_pool(size_t size){
+		node_size = (size + 7) & ~(size_t)7;
+	}
+	void build_node_pool(){
+		if (slab_alloc && node_size != 0 && node_pool == NULL)
+			node_pool = new NodePool(node_size + max_extra + prefix);
+	}
+	inline void* node_alloc(size_t size){
+		char* ptr;
+		if (node_pool)
+			ptr = (char*) node_pool->alloc();
+		else
+			ptr = (char*) malloc((alloc_extra ? node_size + alloc_extra : size) + prefix);
+		if (prefix){
+			ptr += prefix;
+			deleter((T*)ptr) = NULL;
+		}
+		return ptr;
+	}
+
+	// Variable-size nodes: alloc(tid, extra) adds up to max bytes after
+	// the tracker's header, found with node_extra(). Slab blocks are all
+	// grown to the largest size.
+	void init_node_extra(size_t max){
+		if (max == 0)
+			return;
+		if (node_size == 0)
+			errexit("init_node_extra - tracker does not use node_alloc.");
+		if (node_pool)
+			errexit("init_node_extra - node pool already built.");
+		max_extra = max;
+	}
+
+	// Typed nodes: every node gets a word in front of it for a Deleter,
+	// so objects of several types can share one tracker, its epochs and
+	// its scans. A node keeps T's place (for T or any object that fits
+	// there) and may carry extra bytes after the header; the deleter
+	// set by alloc(tid, extra, del) or retire(obj, tid, del) destroys
+	// whatever was built in both. Nodes without one are destroyed as T.
+	void init_typed(){
+		if (node_size == 0)
+			errexit("init_typed - tracker does not use node_alloc.");
+		if (node_pool)
+			errexit("init_typed - node pool already built.");
+		prefix = alignof(std::max_align_t);
+	}
+	bool is_typed(){
+		return prefix != 0;
+	}
+	static inline Deleter& deleter(T* obj){
+		return *(Deleter*)((char*)obj - sizeof(Deleter));
+	}
+	void* alloc(int tid, size_t extra, Deleter del){
+		assert(prefix != 0);
+		void* ptr = alloc(tid, extra);
+		deleter((T*)ptr) = del;
+		return ptr;
+	}
+	void set_deleter(T* obj, Deleter del){
+		assert(prefix != 0);
+		deleter(obj) = del;
+	}
+	void* alloc(int tid, size_t extra){
+		assert(extra <= max_extra);
+		alloc_extra = extra;
+		void* ptr = alloc(tid);
+		alloc_extra = 0;
+		return ptr;
+	}
+	inline void* node_extra(T* obj){
+		return (char*)obj + node_size;
+	}
+	inline void node_free(void* ptr){
+		ptr = (char*)ptr - prefix;
+		if (node_pool)
+			node_pool->free(ptr);
+		else
+			free(ptr);
+	}
+
+	// Hands reclaimed nodes to background threads (-dreclaimers=N).
+	// Needs a tracker header of at least one word after T.
+	void init_reclaimer(GlobalTestConfig* gtc, int num){
+		if (num > 0)
+			reclaimer = new Reclaimer<T>(this, gtc, num);
+	}
+	void flush_reclaimer(){
+		if (reclaimer)
+			reclaimer->flush();
+	}
+	// Called by each harness thread when it leaves the run.
+	void exit_reclaimer(){
+		if (reclaimer)
+			reclaimer->worker_exit();
+	}
+	uint64_t get_reclaimer_ns(){
+		return reclaimer ? reclaimer->cpu_time() : 0;
+	}
+
+	// Bounded freeing (-dfree_budget=N). Trackers that release whole
+	// batches at once pass them through reclaim_bounded; the nodes wait
+	// on a per-thread pending list, linked through the header after T,
+	// and at most N of them are reclaimed per start_op/end_op. A thread
+	// never keeps more than N*PENDING_OPS nodes pending.
+	void init_free_budget(size_t budget){
+		if (budget == 0)
+			return;
+		free_budget = budget;
+		pending = (Pending*) memalign(alignof(Pending), sizeof(Pending) * MAX_POOL_THREADS);
+		for (int i = 0; i < MAX_POOL_THREADS; i++){
+			pending[i].head = NULL;
+			pending[i].count = 0;
+		}
+	}
+	inline void reclaim_bounded(T* obj){
+		if (pending == NULL){
+			reclaim(obj);
+			return;
+		}
+		int id = NodePool::thread_id();
+		if (id >= MAX_POOL_THREADS)
+			errexit("reclaim_bounded - too many threads.");
+		Pending* p = &pending[id];
+		if (p->count >= free_budget * PENDING_OPS){
+			reclaim(obj);
+			return;
+		}
+		*(T**)(obj + 1) = p->head;
+		p->head = obj;
+		p->count++;
+	}
+	inline void drain_pending(){
+		if (pending != NULL)
+			drain(&pending[NodePool::thread_id()], free_budget);
+	}
+	void flush_pending(){
+		if (pending != NULL)
+			drain(&pending[NodePool::thread_id()], SIZE_MAX);
+	}
+
+	// Destroys and frees a node in the calling thread.
+	inline void destroy(T* obj){
+		if (prefix && deleter(obj))
+			deleter(obj)(obj, node_extra(obj));
+		else
+			obj->~T();
+		this->node_free(obj);
+	}
+
 	virtual void* alloc(int tid){
 		return alloc();
 	}
 
 	virtual void* alloc(){
-		return (void*)malloc(sizeof(T));
+		return this->node_alloc(sizeof(T));
 	}
 	//NOTE: reclaim shall be only used to thread-local objects.
 	virtual void reclaim(T* obj){
 		assert(obj != NULL);
-		obj->~T();
-		free(obj);
+		if (reclaimer)
+			reclaimer->push(obj);
+		else
+			destroy(obj);
 	}
 
 	//NOTE: reclaim (obj, tid) should be used on all retired objects.
@@ -94,7 +397,25 @@ public:
 
 	virtual void clear_all(int tid){}
 
+	// Read phases, for trackers that neutralize threads (NBR): the
+	// thread may be sent back to read_checkpoint() until end_read(),
+	// which reserves the n nodes in keep for the write phase.
+	virtual sigjmp_buf* read_checkpoint(int tid){ return NULL; }
+
+	virtual void begin_read(int tid){}
+
+	virtual void end_read(int tid, T* const* keep, int n){}
+
+	// Called outside of any operation by a thread giving up tid: drops
+	// its reservations so it holds back no reclamation. Trackers with
+	// retired lists also scan them once here.
+	virtual void thread_exit(int tid){
+		clear_all(tid);
+	}
+
 	virtual void retire(T* obj, int tid){}
 };
 
+template<class T> thread_local size_t BaseTracker<T>::alloc_extra = 0;
+
 #endif
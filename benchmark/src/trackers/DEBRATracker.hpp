@@ -0,0 +1,192 @@
+/*
+
+Copyright 2017 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+#ifndef DEBRA_TRACKER_HPP
+#define DEBRA_TRACKER_HPP
+
+#include <atomic>
+#include "ConcurrentPrimitives.hpp"
+#include "RAllocator.hpp"
+
+#include "BaseTracker.hpp"
+
+#define DEBRA_BAGS	3
+
+// Distributed epoch-based reclamation after Brown (2015). Each thread
+// announces the epoch it works in (the low bit marks it quiescent),
+// checks one other thread per operation, and advances the epoch after
+// it has seen all of them quiescent or in the current epoch. Nodes
+// go to the bag of the epoch their thread announced; the bag comes
+// round again, and is freed as a whole, three observed epochs later.
+// A thread giving up its tid leaves its bags on a shared orphan list,
+// and the first thread to see the epoch three past theirs frees them.
+template<class T> class DEBRATracker: public BaseTracker<T>{
+private:
+	int task_num;
+	bool collect;
+
+public:
+	struct DEBRAInfo {
+		struct DEBRAInfo* next;
+	};
+
+	struct alignas(128) DEBRAThread {
+		DEBRAInfo* bags[DEBRA_BAGS];
+		int cur;
+		int checked;
+	};
+
+	// The bags of an exited thread, retired no later than epoch.
+	struct DEBRAOrphan {
+		DEBRAInfo* bag;
+		uint64_t epoch;
+		DEBRAOrphan* next;
+	};
+
+private:
+	paddedAtomic<uint64_t>* announce;
+	DEBRAThread* threads;
+
+	paddedAtomic<uint64_t> epoch;
+	paddedAtomic<DEBRAOrphan*> orphans;
+
+	void free_bag(DEBRAInfo* info){
+		while (info != nullptr){
+			DEBRAInfo* curr = info;
+			info = curr->next;
+			this->reclaim_bounded((T*)curr - 1);
+			this->dec_retired(0); // tid=0, not used
+		}
+	}
+
+	void push_orphan(DEBRAOrphan* o){
+		DEBRAOrphan* head = orphans.ui.load(std::memory_order_relaxed);
+		do {
+			o->next = head;
+		} while (!orphans.ui.compare_exchange_weak(head, o, std::memory_order_release));
+	}
+
+	// Takes the whole orphan list, frees the bags that are old enough
+	// in epoch e and puts the others back.
+	void adopt_orphans(uint64_t e){
+		DEBRAOrphan* o = orphans.ui.exchange(nullptr, std::memory_order_acquire);
+		while (o != nullptr){
+			DEBRAOrphan* next = o->next;
+			if (o->epoch + DEBRA_BAGS <= e){
+				free_bag(o->bag);
+				delete o;
+			} else {
+				push_orphan(o);
+			}
+			o = next;
+		}
+	}
+
+public:
+	~DEBRATracker(){};
+	DEBRATracker(int task_num, bool collect):
+	 BaseTracker<T>(task_num),task_num(task_num),collect(collect){
+		announce = new paddedAtomic<uint64_t>[task_num];
+		threads = (DEBRAThread*) memalign(alignof(DEBRAThread), sizeof(DEBRAThread) * task_num);
+		for (int i = 0; i<task_num; i++){
+			announce[i].ui.store(1, std::memory_order_release); // quiescent in epoch 0
+			for (int j = 0; j<DEBRA_BAGS; j++){
+				threads[i].bags[j] = nullptr;
+			}
+			threads[i].cur = 0;
+			threads[i].checked = 0;
+		}
+		epoch.ui.store(0, std::memory_order_release);
+		orphans.ui.store(nullptr, std::memory_order_release);
+		this->add_meta_bytes((sizeof(paddedAtomic<uint64_t>) + sizeof(DEBRAThread)) * task_num);
+		this->init_node_pool(sizeof(T) + sizeof(DEBRAInfo));
+	}
+
+	void* alloc(int tid){
+		return (void*)this->node_alloc(sizeof(T)+sizeof(DEBRAInfo));
+	}
+
+	void start_op(int tid){
+		DEBRAThread* t = &threads[tid];
+		uint64_t e = epoch.ui.load(std::memory_order_acquire);
+		if ((announce[tid].ui.load(std::memory_order_relaxed) >> 1) != e){
+			// a new epoch: reuse the oldest bag
+			t->cur = (t->cur + 1) % DEBRA_BAGS;
+			if (collect){
+				free_bag(t->bags[t->cur]);
+				if (orphans.ui.load(std::memory_order_relaxed) != nullptr)
+					adopt_orphans(e);
+			}
+			t->bags[t->cur] = nullptr;
+			t->checked = 0;
+		}
+		announce[tid].ui.store(e << 1, std::memory_order_seq_cst);
+
+		if (t->checked < task_num){
+			uint64_t a = announce[t->checked].ui.load(std::memory_order_acquire);
+			if ((a & 1) || (a >> 1) == e)
+				t->checked++;
+		}
+		if (t->checked == task_num){
+			epoch.ui.compare_exchange_strong(e, e + 1, std::memory_order_acq_rel);
+			t->checked++;
+		}
+	}
+
+	void end_op(int tid){
+		uint64_t a = announce[tid].ui.load(std::memory_order_relaxed);
+		announce[tid].ui.store(a | 1, std::memory_order_release);
+	}
+
+	void retire(T* obj, int tid){
+		if (obj==NULL){return;}
+		DEBRAThread* t = &threads[tid];
+		DEBRAInfo* info = (DEBRAInfo*) (obj + 1);
+		info->next = t->bags[t->cur];
+		t->bags[t->cur] = info;
+	}
+
+	// The bags of tid were all filled in its last announced epoch or
+	// before, so they are safe to free DEBRA_BAGS epochs after it.
+	void thread_exit(int tid){
+		DEBRAThread* t = &threads[tid];
+		uint64_t a = announce[tid].ui.load(std::memory_order_relaxed);
+		announce[tid].ui.store(a | 1, std::memory_order_release);
+		DEBRAInfo* bag = nullptr;
+		for (int i = 0; i<DEBRA_BAGS; i++){
+			DEBRAInfo* info = t->bags[i];
+			t->bags[i] = nullptr;
+			while (collect && info != nullptr){
+				DEBRAInfo* next = info->next;
+				info->next = bag;
+				bag = info;
+				info = next;
+			}
+		}
+		t->checked = 0;
+		if (bag != nullptr)
+			push_orphan(new DEBRAOrphan{bag, a >> 1, nullptr});
+	}
+
+	bool collecting(){return collect;}
+};
+
+
+#endif
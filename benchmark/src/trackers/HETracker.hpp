@@ -29,8 +29,7 @@ limitations under the License.
 #include "RAllocator.hpp"
 
 #include "BaseTracker.hpp"
-
-#define MAX_HE		16
+#include "IntervalScan.hpp"
 
 template<class T> class HETracker: public BaseTracker<T>{
 private:
@@ -39,6 +38,8 @@ private:
 	int epochFreq;
 	int freq;
 	bool collect;
+	ScanType scan;
+	FenceType fence;
 
 	
 public:
@@ -48,37 +49,47 @@ public:
 		uint64_t retire_epoch;
 	};
 
-	struct HESlot {
-		std::atomic<uint64_t> entry[MAX_HE];
-		alignas(128) char pad[0];
-	};
-
 private:
-	HESlot* reservations;
-	HESlot* local_reservations;
+	SlotArray<std::atomic<uint64_t>> reservations;
 	padded<uint64_t>* retire_counters;
 	padded<uint64_t>* alloc_counters;
 	padded<HEInfo*>* retired;
+	padded<IntervalScan>* scans;
 
 	paddedAtomic<uint64_t> epoch;
 
 public:
 	~HETracker(){};
-	HETracker(int task_num, int he_num, int epochFreq, int emptyFreq, bool collect): 
-	 BaseTracker<T>(task_num),task_num(task_num),he_num(he_num),epochFreq(epochFreq),freq(emptyFreq),collect(collect){
+	HETracker(int task_num, int he_num, int epochFreq, int emptyFreq, ScanType scan, FenceType fence, bool collect): 
+	 BaseTracker<T>(task_num),task_num(task_num),he_num(he_num),epochFreq(epochFreq),freq(emptyFreq),collect(collect),scan(scan),fence(fence){
+		if (fence == fence_asym)
+			asym_fence_init();
 		retired = new padded<HEInfo*>[task_num];
-		reservations = (HESlot *) memalign(alignof(HESlot), sizeof(HESlot) * task_num);
-		local_reservations = (HESlot*) memalign(alignof(HESlot), sizeof(HESlot) * task_num * task_num);
+		reservations.init(task_num, he_num);
 		for (int i = 0; i<task_num; i++){
 			retired[i].ui = nullptr;
 			for (int j = 0; j<he_num; j++){
-				reservations[i].entry[j].store(0, std::memory_order_release);
+				reservations[i][j].store(0, std::memory_order_release);
 			}
 		}
 		retire_counters = new padded<uint64_t>[task_num];
 		alloc_counters = new padded<uint64_t>[task_num];
 		epoch.ui.store(1, std::memory_order_release); // use 0 as infinity
+		// one snapshot buffer of task_num*he_num epochs per thread,
+		// reused by every scan
+		scans = new padded<IntervalScan>[task_num];
+		for (int i = 0; i<task_num; i++){
+			scans[i].ui.init(task_num * he_num);
+		}
+		this->add_meta_bytes(reservations.bytes() +
+			(sizeof(padded<uint64_t>) * 2 + sizeof(padded<HEInfo*>) +
+			 sizeof(padded<IntervalScan>) + sizeof(uint64_t) * task_num * he_num) * task_num);
+		this->init_node_pool(sizeof(T) + sizeof(HEInfo));
 	}
+	HETracker(int task_num, int he_num, int epochFreq, int emptyFreq, ScanType scan, bool collect): 
+		HETracker(task_num,he_num,epochFreq,emptyFreq,scan,fence_seq_cst,collect){}
+	HETracker(int task_num, int he_num, int epochFreq, int emptyFreq, bool collect): 
+		HETracker(task_num,he_num,epochFreq,emptyFreq,scan_linear,collect){}
 	HETracker(int task_num, int emptyFreq) : HETracker(task_num,emptyFreq,true){}
 
 	void __attribute__ ((deprecated)) reserve(uint64_t e, int tid){
@@ -93,40 +104,44 @@ public:
 		if(alloc_counters[tid]%(epochFreq*task_num)==0){
 			epoch.ui.fetch_add(1,std::memory_order_acq_rel);
 		}
-		char* block = (char*) malloc(sizeof(HEInfo) + sizeof(T));
+		char* block = (char*) this->node_alloc(sizeof(HEInfo) + sizeof(T));
 		HEInfo* info = (HEInfo*) (block + sizeof(T));
 		info->birth_epoch = getEpoch();
 		return (void*)block;
 	}
 
-	void reclaim(T* obj){
-		obj->~T();
-		free ((char*)obj);
+	inline void publish(uint64_t curr_epoch, int index, int tid){
+		if (fence == fence_asym){
+			reservations[tid][index].store(curr_epoch, std::memory_order_release);
+			asym_light_fence();
+		} else {
+			reservations[tid][index].store(curr_epoch, std::memory_order_seq_cst);
+		}
 	}
 
 	T* read(std::atomic<T*>& obj, int index, int tid, T* node){
-		uint64_t prev_epoch = reservations[tid].entry[index].load(std::memory_order_acquire);
+		uint64_t prev_epoch = reservations[tid][index].load(std::memory_order_acquire);
 		while(true){
 			T* ptr = obj.load(std::memory_order_acquire);
 			uint64_t curr_epoch = getEpoch();
 			if (curr_epoch == prev_epoch){
 				return ptr;
 			} else {
-				// reservations[tid].entry[index].store(curr_epoch, std::memory_order_release);
-				reservations[tid].entry[index].store(curr_epoch, std::memory_order_seq_cst);
+				// reservations[tid][index].store(curr_epoch, std::memory_order_release);
+				publish(curr_epoch, index, tid);
 				prev_epoch = curr_epoch;
 			}
 		}
 	}
 
 	void reserve_slot(T* obj, int index, int tid, T* node){
-		uint64_t prev_epoch = reservations[tid].entry[index].load(std::memory_order_acquire);
+		uint64_t prev_epoch = reservations[tid][index].load(std::memory_order_acquire);
 		while(true){
 			uint64_t curr_epoch = getEpoch();
 			if (curr_epoch == prev_epoch){
 				return;
 			} else {
-				reservations[tid].entry[index].store(curr_epoch, std::memory_order_seq_cst);
+				publish(curr_epoch, index, tid);
 				prev_epoch = curr_epoch;
 			}
 		}
@@ -136,7 +151,17 @@ public:
 	void clear_all(int tid){
 		//reservations[tid].entry.store(UINT64_MAX,std::memory_order_release);
 		for (int i = 0; i < he_num; i++){
-			reservations[tid].entry[i].store(0, std::memory_order_seq_cst);
+			reservations[tid][i].store(0, std::memory_order_seq_cst);
+		}
+	}
+
+	void thread_exit(int tid){
+		clear_all(tid);
+		if (collect){
+			if (scan == scan_sorted)
+				empty_sorted(tid);
+			else
+				empty(tid);
 		}
 	}
 
@@ -152,42 +177,62 @@ public:
 		info->next = *field;
 		*field = info;
 		if (collect && retire_counters[tid]%freq==0){
-			empty(tid);
+			auto start = std::chrono::steady_clock::now();
+			if (scan == scan_sorted)
+				empty_sorted(tid);
+			else
+				empty(tid);
+			this->add_scan_time(start, tid);
 		}
 		retire_counters[tid]=retire_counters[tid]+1;
 	}
 
-	bool can_delete(HESlot* local, uint64_t birth_epoch, uint64_t retire_epoch) {
-		for (int i = 0; i < task_num; i++){
-			for (int j = 0; j < he_num; j++){
-				const uint64_t epo = local[i].entry[j].load(std::memory_order_acquire);
-				if (epo < birth_epoch || epo > retire_epoch || epo == 0){
-					continue;
-				} else {
-					return false;
-				}
+	// Copies all non-zero reservations into this thread's snapshot.
+	IntervalScan* take_snapshot(int tid) {
+		IntervalScan* local = &scans[tid].ui;
+		local->clear();
+		if (fence == fence_asym)
+			asym_heavy_fence();
+		for (int i = 0; i < task_num; i++) {
+			for (int j = 0; j < he_num; j++) {
+				const uint64_t epo = reservations[i][j].load(std::memory_order_acquire);
+				if (epo != 0) local->add(epo);
 			}
 		}
-		return true;
+		return local;
 	}
 
 	void empty(int tid) {
 		// erase safe objects
-		HESlot* local = local_reservations + tid * task_num;
 		HEInfo** field = &(retired[tid].ui);
 		HEInfo* info = *field;
 		if (info == nullptr) return;
-		for (int i = 0; i < task_num; i++) {
-			for (int j = 0; j < he_num; j++) {
-				local[i].entry[j].store(reservations[i].entry[j].load(std::memory_order_acquire), std::memory_order_relaxed);
+		IntervalScan* local = take_snapshot(tid);
+		do {
+			HEInfo* curr = info;
+			info = curr->next;
+			if (!local->conflict_linear(curr->birth_epoch, curr->retire_epoch)) {
+				*field = info;
+				this->reclaim((T*)curr - 1);
+				this->dec_retired(tid);
+				continue;
 			}
-		}
+			field = &curr->next;
+		} while (info != nullptr);
+	}
+
+	void empty_sorted(int tid) {
+		HEInfo** field = &(retired[tid].ui);
+		HEInfo* info = *field;
+		if (info == nullptr) return;
+		IntervalScan* local = take_snapshot(tid);
+		local->sort();
 		do {
 			HEInfo* curr = info;
 			info = curr->next;
-			if (can_delete(local, curr->birth_epoch, curr->retire_epoch)) {
+			if (!local->conflict(curr->birth_epoch, curr->retire_epoch)) {
 				*field = info;
-				reclaim((T*)curr - 1);
+				this->reclaim((T*)curr - 1);
 				this->dec_retired(tid);
 				continue;
 			}
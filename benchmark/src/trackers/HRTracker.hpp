@@ -36,7 +36,6 @@
 #include "BaseTracker.hpp"
 
 #define HR_INVPTR	((HRInfo*)-1LL)
-#define MAX_HR		16
 #define MAX_HRC		12
 
 template<class T> class HRTracker: public BaseTracker<T>{
@@ -46,6 +45,7 @@ private:
 	int epochFreq;
 	int freq;
 	bool collect;
+	FenceType fence;
 
 	
 public:
@@ -80,23 +80,26 @@ public:
 
 	struct HRSlot {
 		// do not reorder
-		std::atomic<HRInfo*> first[MAX_HR];
-		std::atomic<uint64_t> epoch[MAX_HR];
-		alignas(128) char pad[0];
+		std::atomic<HRInfo*> first;
+		std::atomic<uint64_t> epoch;
 	};
 
 private:
-	HRSlot* slots;
+	SlotArray<HRSlot> slots;
+	SlotArray<HRInfo*> firsts;
 	HRBatch* batches;
 	padded<uint64_t>* alloc_counters;
 	paddedAtomic<uint64_t> epoch;
 
 public:
 	~HRTracker() { };
-	HRTracker(int task_num, int hr_num, int epochFreq, int emptyFreq, bool collect): 
-	 BaseTracker<T>(task_num),task_num(task_num),hr_num(hr_num),epochFreq(epochFreq*task_num),freq(emptyFreq),collect(collect){
+	HRTracker(int task_num, int hr_num, int epochFreq, int emptyFreq, FenceType fence, bool collect): 
+	 BaseTracker<T>(task_num),task_num(task_num),hr_num(hr_num),epochFreq(epochFreq*task_num),freq(emptyFreq),collect(collect),fence(fence){
+		if (fence == fence_asym)
+			asym_fence_init();
 		batches = (HRBatch*) memalign(alignof(HRBatch), sizeof(HRBatch) * task_num);
-		slots = (HRSlot*) memalign(alignof(HRSlot), sizeof(HRSlot) * task_num);
+		slots.init(task_num, hr_num);
+		firsts.init(task_num, hr_num);
 		alloc_counters = new padded<uint64_t>[task_num];
 		for (int i = 0; i<task_num; i++) {
 			alloc_counters[i].ui = 0;
@@ -105,12 +108,17 @@ public:
 			batches[i].list_count = 0;
 			batches[i].list = nullptr;
 			for (int j = 0; j<hr_num; j++){
-				slots[i].first[j].store(HR_INVPTR, std::memory_order_release);
-				slots[i].epoch[j].store(0, std::memory_order_release);
+				slots[i][j].first.store(HR_INVPTR, std::memory_order_release);
+				slots[i][j].epoch.store(0, std::memory_order_release);
 			}
 		}
 		epoch.ui.store(1, std::memory_order_release);
+		this->add_meta_bytes(slots.bytes() + firsts.bytes() +
+			(sizeof(HRBatch) + sizeof(padded<uint64_t>)) * task_num);
+		this->init_node_pool(sizeof(T) + sizeof(HRInfo));
 	}
+	HRTracker(int task_num, int hr_num, int epochFreq, int emptyFreq, bool collect): 
+		HRTracker(task_num,hr_num,epochFreq,emptyFreq,fence_seq_cst,collect){}
 	HRTracker(int task_num, int emptyFreq) : HRTracker(task_num,emptyFreq,true){}
 
 	void __attribute__ ((deprecated)) reserve(uint64_t e, int tid) {
@@ -125,17 +133,12 @@ public:
 		if (alloc_counters[tid] % epochFreq == 0){
 			epoch.ui.fetch_add(1, std::memory_order_acq_rel);
 		}
-		char* block = (char*) malloc(sizeof(HRInfo) + sizeof(T));
+		char* block = (char*) this->node_alloc(sizeof(HRInfo) + sizeof(T));
 		HRInfo* info = (HRInfo*) (block + sizeof(T));
 		info->birth_epoch = getEpoch();
 		return (void*) block;
 	}
 
-	void reclaim(T* obj) {
-		obj->~T();
-		free ((char*) obj);
-	}
-
 	inline void free_list(HRInfo* list) {
 		while (list != nullptr) {
 			HRInfo* start = list->batch_link;
@@ -143,7 +146,7 @@ public:
 			do {
 				T* obj = (T*) start - 1;
 				start = start->batch_next;
-				reclaim(obj);
+				this->reclaim_bounded(obj);
 				this->dec_retired(0); // tid=0, not used
 			} while (start != nullptr);
 		}
@@ -177,18 +180,28 @@ public:
 
 	__attribute__((noinline)) uint64_t do_update(uint64_t curr_epoch, int index, int tid) {
 		// Dereference previous nodes
-		if (slots[tid].first[index].load(std::memory_order_acquire) != nullptr) {
-			HRInfo* first = slots[tid].first[index].exchange(HR_INVPTR, std::memory_order_acq_rel);
+		if (slots[tid][index].first.load(std::memory_order_acquire) != nullptr) {
+			HRInfo* first = slots[tid][index].first.exchange(HR_INVPTR, std::memory_order_acq_rel);
 			if (first != HR_INVPTR) traverse_cache(&batches[tid], first);
-			slots[tid].first[index].store(nullptr, std::memory_order_seq_cst);
+			if (fence == fence_asym){
+				slots[tid][index].first.store(nullptr, std::memory_order_release);
+				asym_light_fence();
+			} else {
+				slots[tid][index].first.store(nullptr, std::memory_order_seq_cst);
+			}
 			curr_epoch = getEpoch();
 		}
-		slots[tid].epoch[index].store(curr_epoch, std::memory_order_seq_cst);
+		if (fence == fence_asym){
+			slots[tid][index].epoch.store(curr_epoch, std::memory_order_release);
+			asym_light_fence();
+		} else {
+			slots[tid][index].epoch.store(curr_epoch, std::memory_order_seq_cst);
+		}
 		return curr_epoch;
 	}
 
 	T* read(std::atomic<T*>& obj, int index, int tid, T* node) {
-		uint64_t prev_epoch = slots[tid].epoch[index].load(std::memory_order_acquire);
+		uint64_t prev_epoch = slots[tid][index].epoch.load(std::memory_order_acquire);
 		while (true) {
 			T* ptr = obj.load(std::memory_order_acquire);
 			uint64_t curr_epoch = getEpoch();
@@ -201,7 +214,7 @@ public:
 	}
 
 	void reserve_slot(T* obj, int index, int tid, T* node) {
-		uint64_t prev_epoch = slots[tid].epoch[index].load(std::memory_order_acquire);
+		uint64_t prev_epoch = slots[tid][index].epoch.load(std::memory_order_acquire);
 		while (true) {
 			uint64_t curr_epoch = getEpoch();
 			if (curr_epoch == prev_epoch){
@@ -213,9 +226,9 @@ public:
 	}
 
 	void clear_all(int tid) {
-		HRInfo* first[MAX_HR];
+		HRInfo** first = firsts[tid];
 		for (int i = 0; i < hr_num; i++) {
-			first[i] = slots[tid].first[i].exchange(HR_INVPTR, std::memory_order_acq_rel);
+			first[i] = slots[tid][i].first.exchange(HR_INVPTR, std::memory_order_acq_rel);
 		}
 		for (int i = 0; i < hr_num; i++) {
 			if (first[i] != HR_INVPTR)
@@ -232,17 +245,19 @@ public:
 		uint64_t min_epoch = batch->min_epoch;
 		// Find available slots
 		HRInfo* last = curr;
+		if (fence == fence_asym)
+			asym_heavy_fence();
 		for (int i = 0; i < task_num; i++) {
 			for (int j = 0; j < hr_num; j++) {
-				HRInfo* first = slots[i].first[j].load(std::memory_order_acquire);
+				HRInfo* first = slots[i][j].first.load(std::memory_order_acquire);
 				if (first == HR_INVPTR)
 					continue;
-				uint64_t epoch = slots[i].epoch[j].load(std::memory_order_acquire);
+				uint64_t epoch = slots[i][j].epoch.load(std::memory_order_acquire);
 				if (epoch < min_epoch)
 					continue;
 				if (last == refs)
 					return;
-				last->slot = &slots[i].first[j];
+				last->slot = &slots[i][j].first;
 				last = last->batch_next;
 			}
 		}
@@ -250,7 +265,7 @@ public:
 		size_t adjs = 0;
 		for (; curr != last; curr = curr->batch_next) {
 			std::atomic<HRInfo*>* slot_first = curr->slot;
-			std::atomic<uint64_t>* slot_epoch = (std::atomic<uint64_t>*) (slot_first + MAX_HR);
+			std::atomic<uint64_t>* slot_epoch = &((HRSlot*) slot_first)->epoch;
 			HRInfo* prev = slot_first->load(std::memory_order_acquire);
 			do {
 				if (prev == HR_INVPTR)
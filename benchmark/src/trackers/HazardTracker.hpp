@@ -29,14 +29,14 @@ limitations under the License.
 #include <list>
 #include <vector>
 #include <atomic>
+#include <algorithm>
+#include <functional>
 #include "ConcurrentPrimitives.hpp"
 #include "RAllocator.hpp"
 
 #include "BaseTracker.hpp"
 
 
-#define MAX_HP		16
-
 template<class T>
 class HazardTracker: public BaseTracker<T>{
 private:
@@ -44,6 +44,8 @@ private:
 	int slotsPerThread;
 	int freq;
 	bool collect;
+	ScanType scan;
+	FenceType fence;
 
 	RAllocator* mem;
 
@@ -52,38 +54,43 @@ public:
 		struct HazardInfo* next;
 	};
 
-	struct HazardSlot {
-		std::atomic<T*> entry[MAX_HP];
-		alignas(128) char pad[0];
-	};
-
 private:
-	HazardSlot* slots;
-	HazardSlot* local_slots;
+	SlotArray<std::atomic<T*>> slots;
 	padded<HazardInfo*>* retired;
 	padded<int>* cntrs;
+	padded<T**>* snapshots;
+
+	// Copies all non-null hazards into this thread's snapshot buffer
+	// (task_num*slotsPerThread entries, reused across scans).
+	int take_snapshot(int tid) {
+		T** snap = snapshots[tid].ui;
+		int cnt = 0;
+		if (fence == fence_asym)
+			asym_heavy_fence();
+		for (int i = 0; i < task_num; i++) {
+			for (int j = 0; j < slotsPerThread; j++) {
+				T* ptr = slots[i][j].load();
+				if (ptr != NULL) snap[cnt++] = ptr;
+			}
+		}
+		return cnt;
+	}
 
 	void empty(int tid) {
-		HazardSlot* local = local_slots + tid * task_num;
 		HazardInfo** field = &(retired[tid].ui);
 		HazardInfo* info = *field;
 		if (info == nullptr) return;
-		for (int i = 0; i < task_num; i++) {
-			for (int j = 0; j < slotsPerThread; j++) {
-				local[i].entry[j].store(slots[i].entry[j], std::memory_order_relaxed);
-			}
-		}
+		T** snap = snapshots[tid].ui;
+		int cnt = take_snapshot(tid);
 		do {
 			HazardInfo* curr = info;
 			info = curr->next;
 			bool danger = false;
 			auto ptr = (T*)curr - 1;
-			for (int i = 0; i < task_num; i++){
-				for (int j = 0; j < slotsPerThread; j++){ 
-					if (ptr == local[i].entry[j]){
-						danger = true;
-						break;
-					}
+			for (int i = 0; i < cnt; i++){
+				if (ptr == snap[i]){
+					danger = true;
+					break;
 				}
 			}
 			if (!danger) {
@@ -97,17 +104,40 @@ private:
 		return;
 	}
 
+	// Takes one snapshot of all non-null hazards, sorts it, and
+	// then binary-searches it for each retired node:
+	// O(N*K log(N*K) + R log(N*K)) instead of O(R*N*K).
+	void empty_sorted(int tid) {
+		HazardInfo** field = &(retired[tid].ui);
+		HazardInfo* info = *field;
+		if (info == nullptr) return;
+		T** snap = snapshots[tid].ui;
+		int cnt = take_snapshot(tid);
+		std::sort(snap, snap + cnt, std::less<T*>());
+		do {
+			HazardInfo* curr = info;
+			info = curr->next;
+			auto ptr = (T*)curr - 1;
+			if (!std::binary_search(snap, snap + cnt, ptr, std::less<T*>())) {
+				*field = info;
+				this->reclaim(ptr);
+				this->dec_retired(tid);
+				continue;
+			}
+			field = &curr->next;
+		} while (info != nullptr);
+	}
+
 public:
 	~HazardTracker(){};
-	HazardTracker(int task_num, int slotsPerThread, int emptyFreq, bool collect):BaseTracker<T>(task_num){
+	HazardTracker(int task_num, int slotsPerThread, int emptyFreq, ScanType scan, FenceType fence, bool collect):BaseTracker<T>(task_num){
 		this->task_num = task_num;
 		this->slotsPerThread = slotsPerThread;
 		this->freq = emptyFreq;
-		slots = (HazardSlot*) memalign(alignof(HazardSlot), sizeof(HazardSlot) * task_num);
-		local_slots = (HazardSlot*) memalign(alignof(HazardSlot), sizeof(HazardSlot) * task_num * task_num);
+		slots.init(task_num, slotsPerThread);
 		for (int i = 0; i < task_num; i++) {
 			for (int j = 0; j < slotsPerThread; j++) {
-				slots[i].entry[j]=NULL;
+				slots[i][j]=NULL;
 			}
 		}
 		retired = new padded<HazardInfo*>[task_num];
@@ -117,9 +147,26 @@ public:
 			retired[i].ui = nullptr;
 		}
 		this->collect = collect;
+		this->scan = scan;
+		this->fence = fence;
+		if (fence == fence_asym)
+			asym_fence_init();
+		snapshots = new padded<T**>[task_num];
+		for (int i = 0; i<task_num; i++){
+			snapshots[i].ui = new T*[task_num * slotsPerThread];
+		}
+		this->add_meta_bytes(slots.bytes() +
+			sizeof(padded<HazardInfo*>) * task_num +
+			sizeof(padded<int>) * task_num +
+			(sizeof(padded<T**>) + sizeof(T*) * task_num * slotsPerThread) * task_num);
+		this->init_node_pool(sizeof(T) + sizeof(HazardInfo));
 	}
+	HazardTracker(int task_num, int slotsPerThread, int emptyFreq, ScanType scan, bool collect): 
+		HazardTracker(task_num, slotsPerThread, emptyFreq, scan, fence_seq_cst, collect){}
+	HazardTracker(int task_num, int slotsPerThread, int emptyFreq, bool collect): 
+		HazardTracker(task_num, slotsPerThread, emptyFreq, scan_linear, collect){}
 	HazardTracker(int task_num, int slotsPerThread, int emptyFreq): 
-		HazardTracker(task_num, slotsPerThread, emptyFreq, true){}
+		HazardTracker(task_num, slotsPerThread, emptyFreq, scan_linear, true){}
 
 	T* read(std::atomic<T*>& obj, int idx, int tid, T* node){
 		T* ret;
@@ -135,25 +182,40 @@ public:
 	}
 
 	void reserve_slot(T* ptr, int slot, int tid){
-		slots[tid].entry[slot] = ptr;
+		if (fence == fence_asym){
+			slots[tid][slot].store(ptr, std::memory_order_release);
+			asym_light_fence();
+		} else {
+			slots[tid][slot] = ptr;
+		}
 	}
 	void reserve_slot(T* ptr, int slot, int tid, T* node){
-		slots[tid].entry[slot] = ptr;
+		reserve_slot(ptr, slot, tid);
 	}
 	void clearSlot(int slot, int tid){
-		slots[tid].entry[slot] = NULL;
+		slots[tid][slot] = NULL;
 	}
 	void clearAll(int tid){
 		for(int i = 0; i<slotsPerThread; i++){
-			slots[tid].entry[i] = NULL;
+			slots[tid][i] = NULL;
 		}
 	}
 	void clear_all(int tid){
 		clearAll(tid);
 	}
 
+	void thread_exit(int tid){
+		clear_all(tid);
+		if (collect){
+			if (scan == scan_sorted)
+				empty_sorted(tid);
+			else
+				empty(tid);
+		}
+	}
+
 	void* alloc(int tid){
-		return (void*)malloc(sizeof(T)+sizeof(HazardInfo));
+		return (void*)this->node_alloc(sizeof(T)+sizeof(HazardInfo));
 	}
 
 	void retire(T* ptr, int tid){
@@ -164,7 +226,12 @@ public:
 		*field = info;
 		if (collect && cntrs[tid]==freq){
 			cntrs[tid]=0;
-			empty(tid);
+			auto start = std::chrono::steady_clock::now();
+			if (scan == scan_sorted)
+				empty_sorted(tid);
+			else
+				empty(tid);
+			this->add_scan_time(start, tid);
 		}
 		cntrs[tid].ui++;
 	}
@@ -49,26 +49,28 @@ private:
 		_Alignas(LF_CACHE_BYTES) char _pad[0];
 	};
 
-	// All benchmarks use one DS so we can move the smr of the DS here
+	// One smr per tracker; rideables in a shared domain share the tracker
 	struct lfbsmro *smr;
 	struct task_data *taskData;
 	size_t SMR_EFREQ;
 	size_t SMR_ORDER;
 	size_t SMR_BATCH;
 
-	static HyalineOSELTracker *myself;
 public:
 	~HyalineOSELTracker(){};
 
 	HyalineOSELTracker(int task_num, int epochFreq, int emptyFreq, bool collect):
 	BaseTracker<T>(task_num), task_num(task_num), collect(collect) {
-		myself = this;
 		SMR_EFREQ = epochFreq * task_num;
 		SMR_ORDER = calc_next_log2(task_num);
 		size_t SMR_NUM = (1U << SMR_ORDER);
 		SMR_BATCH = (task_num < emptyFreq ? emptyFreq : task_num+1);
 
-		smr = (struct lfbsmro *) memalign(LFBSMRO_ALIGN, LFBSMRO_SIZE(SMR_NUM));
+		// The owning tracker is kept just below the header, where
+		// free_node finds it; several trackers can then coexist
+		char *mem = (char *) memalign(LFBSMRO_ALIGN, LFBSMRO_ALIGN + LFBSMRO_SIZE(SMR_NUM));
+		smr = (struct lfbsmro *) (mem + LFBSMRO_ALIGN);
+		((HyalineOSELTracker **) smr)[-1] = this;
 		taskData = (struct task_data *) memalign(LF_CACHE_BYTES,
 				sizeof(struct task_data) * task_num);
 		for (int i=0; i<task_num; i++) {
@@ -77,13 +79,16 @@ public:
 			lfbsmro_batch_init(&taskData[i].batch);
 		}
 		lfbsmro_init(smr, SMR_ORDER);
+		this->add_meta_bytes(LFBSMRO_SIZE(SMR_NUM) + sizeof(struct task_data) * task_num);
+		this->init_node_pool(sizeof(T) + sizeof(struct lfbsmro_node));
 	}
 
 	static inline void free_node(struct lfbsmro * hdr, struct lfbsmro_node * node)
 	{
+		HyalineOSELTracker * self = ((HyalineOSELTracker **) hdr)[-1];
 		T * dnode = (T *) ((char *) node - sizeof(T));
-		myself->reclaim(dnode);
-		myself->dec_retired(0); // tid=0, it is not used anyway
+		self->reclaim_bounded(dnode);
+		self->dec_retired(0); // tid=0, it is not used anyway
 	}
 
 	void __attribute__ ((deprecated)) reserve(uint64_t e, int tid){
@@ -91,7 +96,7 @@ public:
 	}
 	
 	void* alloc(int tid){
-		char * node = (char *) malloc(sizeof(T) + sizeof(struct lfbsmro_node));
+		char * node = (char *) this->node_alloc(sizeof(T) + sizeof(struct lfbsmro_node));
 		lfbsmro_init_node(smr, (struct lfbsmro_node *) (node + sizeof(T)), &taskData[tid].counter, SMR_EFREQ);
 		return node;
 	}
@@ -113,15 +118,13 @@ public:
 	}
 
 	void last_end_op(int tid){
-#if 0
-	    // Finalize retirement
-	    while (!lfbsmro_batch_empty(&taskData[tid].batch)) {
-		T * retr = (T *) alloc(tid);
-	        lfbsmro_retire(smr, SMR_ORDER,
-			(struct lfbsmro_node *) ((char *) retr + sizeof(T)),
-			free_node, 0, &taskData[tid].batch, SMR_BATCH);
-	    }
-#endif
+		// Retire the partial batch; if more slots are active than it has
+		// nodes, it is kept and retried by the next owner of tid
+		lfbsmro_flush(smr, SMR_ORDER, free_node, 0, &taskData[tid].batch);
+	}
+
+	void thread_exit(int tid){
+		last_end_op(tid);
 	}
 
 	void reserve(int tid){
@@ -150,8 +153,5 @@ public:
 	
 };
 
-template<class T>
-HyalineOSELTracker<T>* HyalineOSELTracker<T>::myself;
-
 
 #endif
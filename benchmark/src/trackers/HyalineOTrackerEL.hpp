@@ -48,24 +48,26 @@ private:
 		_Alignas(LF_CACHE_BYTES) char _pad[0];
 	};
 
-	// All benchmarks use one DS so we can move the smr of the DS here
+	// One smr per tracker; rideables in a shared domain share the tracker
 	struct lfsmro *smr;
 	struct task_data *taskData;
 	size_t SMR_ORDER;
 	size_t SMR_BATCH;
 
-	static HyalineOELTracker *myself;
 public:
 	~HyalineOELTracker(){};
 
 	HyalineOELTracker(int task_num, int epochFreq, int emptyFreq, bool collect):
 	BaseTracker<T>(task_num), task_num(task_num), collect(collect) {
-		myself = this;
 		SMR_ORDER = calc_next_log2(task_num);
 		size_t SMR_NUM = (1U << SMR_ORDER);
 		SMR_BATCH = (task_num < emptyFreq ? emptyFreq : task_num+1);
 
-		smr = (struct lfsmro *) memalign(LFSMRO_ALIGN, LFSMRO_SIZE(SMR_NUM));
+		// The owning tracker is kept just below the header, where
+		// free_node finds it; several trackers can then coexist
+		char *mem = (char *) memalign(LFSMRO_ALIGN, LFSMRO_ALIGN + LFSMRO_SIZE(SMR_NUM));
+		smr = (struct lfsmro *) (mem + LFSMRO_ALIGN);
+		((HyalineOELTracker **) smr)[-1] = this;
 		taskData = (struct task_data *) memalign(LF_CACHE_BYTES,
 				sizeof(struct task_data) * task_num);
 		for (int i=0; i<task_num; i++) {
@@ -73,13 +75,16 @@ public:
 			lfsmro_batch_init(&taskData[i].batch);
 		}
 		lfsmro_init(smr, SMR_ORDER);
+		this->add_meta_bytes(LFSMRO_SIZE(SMR_NUM) + sizeof(struct task_data) * task_num);
+		this->init_node_pool(sizeof(T) + sizeof(struct lfsmro_node));
 	}
 
 	static inline void free_node(struct lfsmro * hdr, struct lfsmro_node * node)
 	{
+		HyalineOELTracker * self = ((HyalineOELTracker **) hdr)[-1];
 		T * dnode = (T *) ((char *) node - sizeof(T));
-		myself->reclaim(dnode);
-		myself->dec_retired(0); // tid=0, it is not used anyway
+		self->reclaim_bounded(dnode);
+		self->dec_retired(0); // tid=0, it is not used anyway
 	}
 
 	void __attribute__ ((deprecated)) reserve(uint64_t e, int tid){
@@ -87,7 +92,7 @@ public:
 	}
 	
 	void* alloc(int tid){
-		return (void*)malloc(sizeof(T) + sizeof(struct lfsmro_node));
+		return (void*)this->node_alloc(sizeof(T) + sizeof(struct lfsmro_node));
 	}
 
 	void start_op(int tid){
@@ -99,13 +104,13 @@ public:
 	}
 
 	void last_end_op(int tid){
-#if 0
-	    // Finalize retirement
-	    while (!lfsmro_batch_empty(&taskData[tid].batch)) {
-		T * retr = (T *) alloc(tid);
-	        lfsmro_retire(smr, SMR_ORDER, (struct lfsmro_node *) ((char *) retr + sizeof(T)), free_node, 0, &taskData[tid].batch, SMR_BATCH);
-	    }
-#endif
+		// Retire the partial batch; if more slots are active than it has
+		// nodes, it is kept and retried by the next owner of tid
+		lfsmro_flush(smr, SMR_ORDER, free_node, 0, &taskData[tid].batch);
+	}
+
+	void thread_exit(int tid){
+		last_end_op(tid);
 	}
 
 	void reserve(int tid){
@@ -132,8 +137,5 @@ public:
 	
 };
 
-template<class T>
-HyalineOELTracker<T>* HyalineOELTracker<T>::myself;
-
 
 #endif
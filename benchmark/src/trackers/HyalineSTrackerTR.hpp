@@ -53,24 +53,26 @@ private:
 		_Alignas(LF_CACHE_BYTES) char _pad[0];
 	};
 
-	//All benchmarks use one DS so we can move the smr of the DS here
+	// One smr per tracker; rideables in a shared domain share the tracker
 	struct lfbsmr *smr;
 	struct task_data *taskData;
 	size_t SMR_ORDER;
 	size_t SMR_BATCH;
 
-	static HyalineSTRTracker *myself;
 public:
 	~HyalineSTRTracker(){};
 
 	HyalineSTRTracker(int task_num, int epochFreq, int emptyFreq, int slots, bool collect):
 	BaseTracker<T>(task_num), task_num(task_num), collect(collect) {
-		myself = this;
 		SMR_ORDER = calc_next_log2(task_num > slots ? slots : task_num);
 		size_t SMR_NUM = (1U << SMR_ORDER);
 		SMR_BATCH = (task_num < 64 ? 64 : SMR_NUM+1);
 
-		smr = (struct lfbsmr *) memalign(LFBSMR_ALIGN, LFBSMR_SIZE(SMR_NUM));
+		// The owning tracker is kept just below the header, where
+		// free_node finds it; several trackers can then coexist
+		char *mem = (char *) memalign(LFBSMR_ALIGN, LFBSMR_ALIGN + LFBSMR_SIZE(SMR_NUM));
+		smr = (struct lfbsmr *) (mem + LFBSMR_ALIGN);
+		((HyalineSTRTracker **) smr)[-1] = this;
 		taskData = (struct task_data *) memalign(LF_CACHE_BYTES,
 				sizeof(struct task_data) * task_num);
 		for (int i=0; i<task_num; i++) {
@@ -80,13 +82,16 @@ public:
 			lfbsmr_batch_init(&taskData[i].batch);
 		}
 		lfbsmr_init(smr, SMR_ORDER);
+		this->add_meta_bytes(LFBSMR_SIZE(SMR_NUM) + sizeof(struct task_data) * task_num);
+		this->init_node_pool(sizeof(T) + sizeof(struct lfbsmr_node));
 	}
 
 	static inline void free_node(struct lfbsmr * hdr, struct lfbsmr_node * node)
 	{
+		HyalineSTRTracker * self = ((HyalineSTRTracker **) hdr)[-1];
 		T * dnode = (T *) ((char *) node - sizeof(T));
-		myself->reclaim(dnode);
-		myself->dec_retired(0); // tid=0, it is not used anyway
+		self->reclaim_bounded(dnode);
+		self->dec_retired(0); // tid=0, it is not used anyway
 	}
 
 	void __attribute__ ((deprecated)) reserve(uint64_t e, int tid){
@@ -94,7 +99,7 @@ public:
 	}
 	
 	void* alloc(int tid){
-		char * node = (char *) malloc(sizeof(T) + sizeof(struct lfbsmr_node));
+		char * node = (char *) this->node_alloc(sizeof(T) + sizeof(struct lfbsmr_node));
 		lfbsmr_init_node(smr, (struct lfbsmr_node *) (node + sizeof(T)), &taskData[tid].counter, SMR_FREQ);
 		return node;
 	}
@@ -119,17 +124,18 @@ public:
 	}
 
 	void last_end_op(int tid){
-		lfbsmr_leave(smr, taskData[tid].enter_num, SMR_ORDER, taskData[tid].handle, free_node, 0, LF_DONTCHECK);
-
-#if 0
-	    // Finalize retirement
-	    while (!lfbsmr_batch_empty(&taskData[tid].batch)) {
-		T * retr = (T *) alloc(tid);
-	        lfbsmr_retire(smr, SMR_ORDER,
-			(struct lfbsmr_node *) ((char *) retr + sizeof(T)),
-			free_node, 0, &taskData[tid].batch, SMR_BATCH);
-	    }
-#endif
+		if (!taskData[tid].firstTime) {
+			taskData[tid].firstTime = true;
+			lfbsmr_leave(smr, taskData[tid].enter_num, SMR_ORDER, taskData[tid].handle, free_node, 0, LF_DONTCHECK);
+		}
+
+		// Retire the partial batch; if more slots are active than it has
+		// nodes, it is kept and retried by the next owner of tid
+		lfbsmr_flush(smr, SMR_ORDER, free_node, 0, &taskData[tid].batch);
+	}
+
+	void thread_exit(int tid){
+		last_end_op(tid);
 	}
 
 	void reserve(int tid){
@@ -158,8 +164,5 @@ public:
 	
 };
 
-template<class T>
-HyalineSTRTracker<T>* HyalineSTRTracker<T>::myself;
-
 
 #endif
@@ -51,24 +51,26 @@ private:
 		_Alignas(LF_CACHE_BYTES) char _pad[0];
 	};
 
-	// All benchmarks use one DS so we can move the smr of the DS here
+	// One smr per tracker; rideables in a shared domain share the tracker
 	struct lfsmr *smr;
 	struct task_data *taskData;
 	size_t SMR_ORDER;
 	size_t SMR_BATCH;
 
-	static HyalineTRTracker *myself;
 public:
 	~HyalineTRTracker(){};
 
 	HyalineTRTracker(int task_num, int epochFreq, int emptyFreq, int slots, bool collect):
 	BaseTracker<T>(task_num), task_num(task_num), collect(collect) {
-		myself = this;
 		SMR_ORDER = calc_next_log2(task_num > slots ? slots : task_num);
 		size_t SMR_NUM = (1U << SMR_ORDER);
 		SMR_BATCH = (task_num < 64 ? 64 : SMR_NUM+1);
 
-		smr = (struct lfsmr *) memalign(LFSMR_ALIGN, LFSMR_SIZE(SMR_NUM));
+		// The owning tracker is kept just below the header, where
+		// free_node finds it; several trackers can then coexist
+		char *mem = (char *) memalign(LFSMR_ALIGN, LFSMR_ALIGN + LFSMR_SIZE(SMR_NUM));
+		smr = (struct lfsmr *) (mem + LFSMR_ALIGN);
+		((HyalineTRTracker **) smr)[-1] = this;
 		taskData = (struct task_data *) memalign(LF_CACHE_BYTES,
 				sizeof(struct task_data) * task_num);
 		for (int i=0; i<task_num; i++) {
@@ -77,13 +79,16 @@ public:
 			lfsmr_batch_init(&taskData[i].batch);
 		}
 		lfsmr_init(smr, SMR_ORDER);
+		this->add_meta_bytes(LFSMR_SIZE(SMR_NUM) + sizeof(struct task_data) * task_num);
+		this->init_node_pool(sizeof(T) + sizeof(struct lfsmr_node));
 	}
 
 	static inline void free_node(struct lfsmr * hdr, struct lfsmr_node * node)
 	{
+		HyalineTRTracker * self = ((HyalineTRTracker **) hdr)[-1];
 		T * dnode = (T *) ((char *) node - sizeof(T));
-		myself->reclaim(dnode);
-		myself->dec_retired(0); // tid=0, it is not used anyway
+		self->reclaim_bounded(dnode);
+		self->dec_retired(0); // tid=0, it is not used anyway
 	}
 
 	void __attribute__ ((deprecated)) reserve(uint64_t e, int tid){
@@ -91,7 +96,7 @@ public:
 	}
 	
 	void* alloc(int tid){
-		return (void*)malloc(sizeof(T) + sizeof(struct lfsmr_node));
+		return (void*)this->node_alloc(sizeof(T) + sizeof(struct lfsmr_node));
 	}
 
 	void start_op(int tid){
@@ -106,15 +111,18 @@ public:
 	}
 
 	void last_end_op(int tid){
-		lfsmr_leave(smr, taskData[tid].enter_num, SMR_ORDER, taskData[tid].handle, free_node, 0, LF_DONTCHECK);
-
-#if 0
-	    // Finalize retirement
-	    while (!lfsmr_batch_empty(&taskData[tid].batch)) {
-		T * retr = (T *) alloc(tid);
-	        lfsmr_retire(smr, SMR_ORDER, (struct lfsmr_node *) ((char *) retr + sizeof(T)), free_node, 0, &taskData[tid].batch, SMR_BATCH);
-	    }
-#endif
+		if (!taskData[tid].firstTime) {
+			taskData[tid].firstTime = true;
+			lfsmr_leave(smr, taskData[tid].enter_num, SMR_ORDER, taskData[tid].handle, free_node, 0, LF_DONTCHECK);
+		}
+
+		// Retire the partial batch; if more slots are active than it has
+		// nodes, it is kept and retried by the next owner of tid
+		lfsmr_flush(smr, SMR_ORDER, free_node, 0, &taskData[tid].batch);
+	}
+
+	void thread_exit(int tid){
+		last_end_op(tid);
 	}
 
 	void reserve(int tid){
@@ -141,8 +149,5 @@ public:
 	
 };
 
-template<class T>
-HyalineTRTracker<T>* HyalineTRTracker<T>::myself;
-
 
 #endif
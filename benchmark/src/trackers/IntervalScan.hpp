@@ -0,0 +1,78 @@
+/*
+
+Copyright 2017 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. 
+
+*/
+
+
+#ifndef INTERVAL_SCAN_HPP
+#define INTERVAL_SCAN_HPP
+
+#include <algorithm>
+#include <cstdint>
+
+// Sorted snapshot of reservation epochs, used by the sorted scans
+// of HETracker and IntervalTracker. A retired node is unsafe iff
+// some reservation falls inside [birth_epoch, retire_epoch].
+//
+// Retired lists are walked in (reverse) retire order, so consecutive
+// nodes mostly share a retire epoch. The upper bound from the
+// previous node is reused while it stays valid, and is otherwise
+// found again by binary search.
+class IntervalScan{
+private:
+	uint64_t* snap = NULL;
+	int cnt = 0;
+	uint64_t* hi = NULL;
+
+public:
+	void init(int max_cnt){
+		snap = new uint64_t[max_cnt];
+	}
+
+	void clear(){
+		cnt = 0;
+	}
+
+	void add(uint64_t epoch){
+		snap[cnt++] = epoch;
+	}
+
+	void sort(){
+		std::sort(snap, snap + cnt);
+		hi = snap + cnt;
+	}
+
+	// For an unsorted snapshot: checks every reservation in turn.
+	bool conflict_linear(uint64_t birth_epoch, uint64_t retire_epoch){
+		for (int i = 0; i < cnt; i++){
+			if (snap[i] >= birth_epoch && snap[i] <= retire_epoch)
+				return true;
+		}
+		return false;
+	}
+
+	bool conflict(uint64_t birth_epoch, uint64_t retire_epoch){
+		uint64_t* end = snap + cnt;
+		// hi must point to the first reservation > retire_epoch.
+		if ((hi != end && *hi <= retire_epoch) ||
+			(hi != snap && *(hi - 1) > retire_epoch)){
+			hi = std::upper_bound(snap, end, retire_epoch);
+		}
+		return hi != snap && *(hi - 1) >= birth_epoch;
+	}
+};
+
+#endif
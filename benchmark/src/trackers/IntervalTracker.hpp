@@ -29,6 +29,7 @@ limitations under the License.
 #include "RAllocator.hpp"
 
 #include "BaseTracker.hpp"
+#include "IntervalScan.hpp"
 
 
 
@@ -38,6 +39,7 @@ private:
 	int freq;
 	int epochFreq;
 	bool collect;
+	ScanType scan;
 	
 public:
 	class IntervalInfo{
@@ -55,13 +57,14 @@ private:
 	padded<uint64_t>* retire_counters;
 	padded<uint64_t>* alloc_counters;
 	padded<std::list<IntervalInfo>>* retired; 
+	padded<IntervalScan>* scans;
 
 	std::atomic<uint64_t> epoch;
 
 public:
 	~IntervalTracker(){};
-	IntervalTracker(int task_num, int epochFreq, int emptyFreq, bool collect): 
-	 BaseTracker<T>(task_num),task_num(task_num),freq(emptyFreq),epochFreq(epochFreq),collect(collect){
+	IntervalTracker(int task_num, int epochFreq, int emptyFreq, ScanType scan, bool collect): 
+	 BaseTracker<T>(task_num),task_num(task_num),freq(emptyFreq),epochFreq(epochFreq),collect(collect),scan(scan){
 		retired = new padded<std::list<IntervalTracker<T>::IntervalInfo>>[task_num];
 		reservations = new paddedAtomic<uint64_t>[task_num];
 		retire_counters = new padded<uint64_t>[task_num];
@@ -71,7 +74,20 @@ public:
 			retired[i].ui.clear();
 		}
 		epoch.store(0,std::memory_order_release);
+		this->add_meta_bytes((sizeof(padded<std::list<IntervalInfo>>) + sizeof(paddedAtomic<uint64_t>) +
+			2 * sizeof(padded<uint64_t>)) * task_num);
+		scans = NULL;
+		if (scan == scan_sorted){
+			scans = new padded<IntervalScan>[task_num];
+			for (int i = 0; i<task_num; i++){
+				scans[i].ui.init(task_num);
+			}
+			this->add_meta_bytes((sizeof(padded<IntervalScan>) + sizeof(uint64_t) * task_num) * task_num);
+		}
+		this->init_node_pool(sizeof(T) + sizeof(uint64_t));
 	}
+	IntervalTracker(int task_num, int epochFreq, int emptyFreq, bool collect) : 
+		IntervalTracker(task_num,epochFreq,emptyFreq,scan_linear,collect){}
 	IntervalTracker(int task_num, int epochFreq, int emptyFreq) : IntervalTracker(task_num,epochFreq,emptyFreq,true){}
 	
 
@@ -87,7 +103,7 @@ public:
 			epoch.fetch_add(1,std::memory_order_acq_rel);
 		}
 		//return (void*)malloc(sizeof(T));
-		char* block = (char*) malloc(sizeof(uint64_t) + sizeof(T));
+		char* block = (char*) this->node_alloc(sizeof(uint64_t) + sizeof(T));
 		uint64_t* birth_epoch = (uint64_t*)(block + sizeof(T));
 		*birth_epoch = getEpoch();
 		return (void*)block;
@@ -96,10 +112,6 @@ public:
 		uint64_t* birth_epoch = (uint64_t*)((char*)obj + sizeof(T));
 		return *birth_epoch;
 	}
-	void reclaim(T* obj){
-		obj->~T();
-		free ((char*)obj);
-	}
 	void start_op(int tid){
 		uint64_t e = epoch.load(std::memory_order_acquire);
 		reservations[tid].ui.store(e,std::memory_order_seq_cst);
@@ -136,7 +148,12 @@ public:
 		IntervalInfo info = IntervalInfo(obj, birth_epoch, retire_epoch);
 		myTrash->push_back(info);	
 		if(collect && retire_counters[tid]%freq==0){
-			empty(tid);
+			auto start = std::chrono::steady_clock::now();
+			if (scan == scan_sorted)
+				empty_sorted(tid);
+			else
+				empty(tid);
+			this->add_scan_time(start, tid);
 		}
 		retire_counters[tid]=retire_counters[tid]+1;
 	}
@@ -145,6 +162,16 @@ public:
 		retire(obj, read_birth(obj), tid);
 	}
 
+	void thread_exit(int tid){
+		clear(tid);
+		if (collect){
+			if (scan == scan_sorted)
+				empty_sorted(tid);
+			else
+				empty(tid);
+		}
+	}
+
 	bool conflict(uint64_t* reservEpoch, uint64_t birth_epoch, uint64_t retire_epoch){
 		for (int i = 0; i < task_num; i++){
 			if (reservEpoch[i] >= birth_epoch && reservEpoch[i] <= retire_epoch){
@@ -173,6 +200,27 @@ public:
 			else{++iterator;}
 		}
 	}
+
+	void empty_sorted(int tid){
+		IntervalScan* local = &scans[tid].ui;
+		local->clear();
+		for (int i = 0; i < task_num; i++){
+			uint64_t e = reservations[i].ui.load(std::memory_order_acquire);
+			if (e != UINT64_MAX) local->add(e);
+		}
+		local->sort();
+
+		std::list<IntervalInfo>* myTrash = &(retired[tid].ui);
+		for (auto iterator = myTrash->begin(), end = myTrash->end(); iterator != end; ) {
+			IntervalInfo res = *iterator;
+			if(!local->conflict(res.birth_epoch, res.retire_epoch)){
+				iterator = myTrash->erase(iterator);
+				this->reclaim(res.obj);
+				this->dec_retired(tid);
+			}
+			else{++iterator;}
+		}
+	}
 		
 	bool collecting(){return collect;}
 	
@@ -25,6 +25,10 @@ limitations under the License.
 #include <list>
 #include <vector>
 #include <atomic>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <typeindex>
 #include "ConcurrentPrimitives.hpp"
 #include "RAllocator.hpp"
 
@@ -45,6 +49,8 @@ limitations under the License.
 #include "WFETracker.hpp"
 #include "HRTracker.hpp"
 #include "WFRTracker.hpp"
+#include "NBRTracker.hpp"
+#include "DEBRATracker.hpp"
 #if !(__x86_64__ || __ppc64__)
 #include "RangeTrackerTP.hpp"
 #endif
@@ -61,9 +67,18 @@ enum TrackerType{
 	Range_new = 8,
 	QSBR = 10,
 	Range_TP = 12,
+	IntervalSort = 24,
+	RCUAsym = 26,
+	DEBRA = 28,
 	//for HP-like trackers.
 	Hazard = 1,
 	Hazard_dynamic = 3,
+	HazardSort = 13,
+	HESort = 25,
+	HazardAsym = 27,
+	HEAsym = 29,
+	HRAsym = 31,
+	NBR = 33,
 	HE = 5,
 	WFE = 7,
 	HR = 9,
@@ -80,28 +95,161 @@ enum TrackerType{
 	HyalineOSTR = 17
 };
 
+// Tids that per-thread state has to cover: the harness threads, the
+// stalled ones, and -dpool_threads more that threads registering
+// mid-run borrow (BaseTracker::register_thread).
+inline int pool_threads(GlobalTestConfig* gtc){
+	int n = gtc->checkEnv("pool_threads") ? atoi((gtc->getEnv("pool_threads")).c_str()) : 0;
+	if (n < 0)
+		errexit("pool_threads must not be negative.");
+	return n;
+}
+inline int tid_count(GlobalTestConfig* gtc){
+	return gtc->task_num + gtc->task_stall + pool_threads(gtc);
+}
+
 class BaseMT {
 public:
 	virtual void lastExit(int tid) = 0;
+	virtual uint64_t scanCount(int tid) = 0;
+	virtual uint64_t scanTime(int tid) = 0;
+	virtual size_t metaBytes() = 0;
+	virtual uint64_t reclaimerTime() = 0;
+	virtual int registerThread() = 0;
+	virtual void unregisterThread(int tid) = 0;
+	// Identifies the reclamation domain; equal for rideables sharing one.
+	virtual const void* domain() = 0;
+
+protected:
+	// Trackers built under a -ddomain name. A MemoryTracker created
+	// later with that name attaches to the same tracker instead of
+	// building its own. The tracker is a BaseTracker of the node type
+	// that built it, so only rideables with that node type can attach;
+	// others must use another name. Rideables are built before the
+	// workers start, so this needs no locking.
+	struct Domain{
+		void* tracker;
+		std::type_index node;
+		TrackerType type;
+		int slot_num;
+		size_t max_extra;
+		bool typed;
+		int epoch_freq;
+		int empty_freq;
+		bool collect;
+		int attached;		// rideables using the tracker
+		padded<int>* left;	// per tid, how many of them lastExit'ed
+	};
+	static std::map<std::string, Domain*>& domains(){
+		static std::map<std::string, Domain*> d;
+		return d;
+	}
 };
 
 extern int count_retired;
 
+// Starts a read phase of an operation on a MemoryTracker. Under NBR a
+// reclaimer's signal sends the thread back here, so the code that
+// follows may only read shared memory, must recompute its locals, and
+// calls end_read() before it writes, allocates or retires.
+#define TRACKER_READ_PHASE(mt, tid)											\
+	do {																	\
+		if ((mt)->neutralized())											\
+			sigsetjmp(*(mt)->read_checkpoint(tid), 0);						\
+		(mt)->begin_read(tid);												\
+	} while (0)
+
+#ifdef STATIC_TRACKER
+// Compile-time tracker selection (make TRACKER=HRTracker).
+// The wrapper is final, so every call made through it is
+// devirtualized and inlined into the rideables. The using
+// declarations restore base overloads that some trackers hide.
+template<class T, template<class> class Impl>
+class StaticTracker final : public Impl<T>{
+public:
+	template<typename... Args>
+	StaticTracker(Args... args) : Impl<T>(args...){}
+
+	using BaseTracker<T>::alloc;
+	using BaseTracker<T>::reclaim;
+	using BaseTracker<T>::start_op;
+	using BaseTracker<T>::end_op;
+	using BaseTracker<T>::last_end_op;
+	using BaseTracker<T>::read;
+	using BaseTracker<T>::reserve_slot;
+	using BaseTracker<T>::release;
+	using BaseTracker<T>::clear_all;
+	using BaseTracker<T>::read_checkpoint;
+	using BaseTracker<T>::begin_read;
+	using BaseTracker<T>::end_read;
+	using BaseTracker<T>::retire;
+	using BaseTracker<T>::get_retired_cnt;
+};
+#endif
+
 template<class T>
 class MemoryTracker : public BaseMT{
 private:
-	BaseTracker<T>* tracker = NULL;
+#ifdef STATIC_TRACKER
+	typedef StaticTracker<T, STATIC_TRACKER> Tracker;
+#else
+	typedef BaseTracker<T> Tracker;
+#endif
+	Tracker* tracker = NULL;
 	TrackerType type = NIL;
 	padded<int*>* slot_renamers = NULL;
+	Domain* shared = NULL;	// NULL for a private tracker
+
+#ifdef STATIC_TRACKER
+	template<template<class> class Impl, typename... Args>
+	Tracker* make(Args... args){
+		return build(typename std::is_same<Impl<T>, STATIC_TRACKER<T>>::type(), args...);
+	}
+
+	template<typename... Args>
+	Tracker* build(std::true_type, Args... args){
+		return new Tracker(args...);
+	}
+
+	template<typename... Args>
+	Tracker* build(std::false_type, Args... args){
+		errexit("constructor - tracker type not compiled in this build.");
+		return NULL;
+	}
+#else
+	template<template<class> class Impl, typename... Args>
+	Tracker* make(Args... args){
+		return new Impl<T>(args...);
+	}
+#endif
 public:
-	MemoryTracker(GlobalTestConfig* gtc, int epoch_freq, int empty_freq, int slot_num, bool collect){
+	// max_extra: largest extra size passed to alloc(tid, extra)
+	// typed: nodes carry deleters, see BaseTracker::init_typed()
+	MemoryTracker(GlobalTestConfig* gtc, int epoch_freq, int empty_freq, int slot_num, bool collect, size_t max_extra = 0, bool typed = false){
 		count_retired = gtc->count_retired;
-		int task_num = gtc->task_num + gtc->task_stall;
+		std::string alloc_type = gtc->getEnv("alloc");
+		if (alloc_type.empty() || alloc_type == "malloc"){
+			slab_alloc = 0;
+		} else if (alloc_type == "slab"){
+			slab_alloc = 1;
+		} else {
+			errexit("constructor - alloc type error.");
+		}
+		int task_num = tid_count(gtc);
 		std::string tracker_type = gtc->getEnv("tracker");
 		if (tracker_type.empty()){
 			tracker_type = "RCU";
 			gtc->setEnv("tracker", "RCU");
 		}
+		// Hyaline slot counts keep their 128/32 defaults up to 128 threads
+		// and grow with task_num beyond that; -dhyaline_slots overrides both
+		int hyaline_slots = task_num > 128 ? task_num : 128;
+		int hyaline_small = task_num > 128 ? task_num / 4 : 32;
+		if (gtc->checkEnv("hyaline_slots")){
+			hyaline_slots = hyaline_small = atoi((gtc->getEnv("hyaline_slots")).c_str());
+			if (hyaline_slots <= 0)
+				errexit("constructor - hyaline_slots must be positive.");
+		}
 
 		slot_renamers = new padded<int*>[task_num];
 		for (int i = 0; i < task_num; i++){
@@ -110,73 +258,127 @@ public:
 				slot_renamers[i].ui[j] = j;
 			}
 		}
+
+		// -ddomain=<name> shares one tracker (epoch, reservations,
+		// retired lists) among the rideables with this node type;
+		// the default, -ddomain=private, gives each its own.
+		std::string domain = gtc->getEnv("domain");
+		if (domain == "private"){
+			domain.clear();
+		}
+		if (!domain.empty() && domains().count(domain)){
+			Domain* d = domains()[domain];
+			if (d->node != std::type_index(typeid(T))){
+				errexit("constructor - domain was built for another node type.");
+			}
+			if (slot_num > d->slot_num || max_extra > d->max_extra || typed != d->typed){
+				errexit("constructor - domain was built with fewer slots, node extra bytes or another typed setting.");
+			}
+			if (epoch_freq != d->epoch_freq || empty_freq != d->empty_freq || collect != d->collect){
+				errexit("constructor - domain was built with another epoch_freq, empty_freq or collect setting.");
+			}
+			tracker = (Tracker*)d->tracker;
+			type = d->type;
+			shared = d;
+			d->attached++;
+			return;
+		}
+
 		if (tracker_type == "NIL"){
-			tracker = new BaseTracker<T>(task_num);
+			tracker = make<BaseTracker>(task_num);
+			tracker->init_node_pool(sizeof(T));
 			type = NIL;
 		} else if (tracker_type == "RCU"){
-			tracker = new RCUTracker<T>(task_num, epoch_freq, empty_freq, collect);
+			tracker = make<RCUTracker>(task_num, epoch_freq, empty_freq, collect);
 			type = RCU;
+		} else if (tracker_type == "RCUAsym"){
+			tracker = make<RCUTracker>(task_num, epoch_freq, empty_freq, type_RCU, fence_asym, collect);
+			type = RCUAsym;
 		} else if (tracker_type == "HyalineEL"){
-			tracker = new HyalineELTracker<T>(task_num, epoch_freq, empty_freq, 128, collect);
+			tracker = make<HyalineELTracker>(task_num, epoch_freq, empty_freq, hyaline_slots, collect);
 			type = HyalineEL;
 		} else if (tracker_type == "HyalineSEL"){
-			tracker = new HyalineSELTracker<T>(task_num, epoch_freq, empty_freq, 128, collect);
+			tracker = make<HyalineSELTracker>(task_num, epoch_freq, empty_freq, hyaline_slots, collect);
 			type = HyalineSEL;
 		}  else if (tracker_type == "HyalineOEL"){
-			tracker = new HyalineOELTracker<T>(task_num, epoch_freq, empty_freq, collect);
+			tracker = make<HyalineOELTracker>(task_num, epoch_freq, empty_freq, collect);
 			type = HyalineOEL;
 		} else if (tracker_type == "HyalineOSEL"){
-			tracker = new HyalineOSELTracker<T>(task_num, epoch_freq, empty_freq, collect);
+			tracker = make<HyalineOSELTracker>(task_num, epoch_freq, empty_freq, collect);
 			type = HyalineOSEL;
 		} else if (tracker_type == "HyalineELSMALL"){
-			tracker = new HyalineELTracker<T>(task_num, epoch_freq, empty_freq, 32, collect);
+			tracker = make<HyalineELTracker>(task_num, epoch_freq, empty_freq, hyaline_small, collect);
 			type = HyalineELSMALL;
 		} else if (tracker_type == "HyalineSELSMALL"){
-			tracker = new HyalineSELTracker<T>(task_num, epoch_freq, empty_freq, 32, collect);
+			tracker = make<HyalineSELTracker>(task_num, epoch_freq, empty_freq, hyaline_small, collect);
 			type = HyalineSELSMALL;
 		} else if (tracker_type == "HyalineTR"){
-			tracker = new HyalineTRTracker<T>(task_num, epoch_freq, empty_freq, 32, collect);
+			tracker = make<HyalineTRTracker>(task_num, epoch_freq, empty_freq, hyaline_small, collect);
 			type = HyalineTR;
 		} else if (tracker_type == "HyalineSTR"){
-			tracker = new HyalineSTRTracker<T>(task_num, epoch_freq, empty_freq, 32, collect);
+			tracker = make<HyalineSTRTracker>(task_num, epoch_freq, empty_freq, hyaline_small, collect);
 			type = HyalineSTR;
 		}  else if (tracker_type == "HyalineOTR"){
-			tracker = new HyalineOTRTracker<T>(task_num, epoch_freq, empty_freq, collect);
+			tracker = make<HyalineOTRTracker>(task_num, epoch_freq, empty_freq, collect);
 			type = HyalineOTR;
 		} else if (tracker_type == "HyalineOSTR"){
-			tracker = new HyalineOSTRTracker<T>(task_num, epoch_freq, empty_freq, collect);
+			tracker = make<HyalineOSTRTracker>(task_num, epoch_freq, empty_freq, collect);
 			type = HyalineOSTR;
 		} else if (tracker_type == "Range_new"){
-			tracker = new RangeTrackerNew<T>(task_num, epoch_freq, empty_freq, collect);
+			tracker = make<RangeTrackerNew>(task_num, epoch_freq, empty_freq, collect);
 			type = Range_new;
 		} else if (tracker_type == "Hazard"){
-			tracker = new HazardTracker<T>(task_num, slot_num, empty_freq, collect);
+			tracker = make<HazardTracker>(task_num, slot_num, empty_freq, collect);
 			type = Hazard;
+		} else if (tracker_type == "HazardSort"){
+			tracker = make<HazardTracker>(task_num, slot_num, empty_freq, scan_sorted, collect);
+			type = HazardSort;
+		} else if (tracker_type == "HazardAsym"){
+			tracker = make<HazardTracker>(task_num, slot_num, empty_freq, scan_linear, fence_asym, collect);
+			type = HazardAsym;
 		} else if (tracker_type == "HE"){
-			// tracker = new HETracker<T>(task_num, slot_num, 1, collect);
-			tracker = new HETracker<T>(task_num, slot_num, epoch_freq, empty_freq, collect);
+			// tracker = make<HETracker>(task_num, slot_num, 1, collect);
+			tracker = make<HETracker>(task_num, slot_num, epoch_freq, empty_freq, collect);
 			type = HE;
+		} else if (tracker_type == "HESort"){
+			tracker = make<HETracker>(task_num, slot_num, epoch_freq, empty_freq, scan_sorted, collect);
+			type = HESort;
+		} else if (tracker_type == "HEAsym"){
+			tracker = make<HETracker>(task_num, slot_num, epoch_freq, empty_freq, scan_linear, fence_asym, collect);
+			type = HEAsym;
 		} else if (tracker_type == "WFE"){
-			tracker = new WFETracker<T>(task_num, slot_num, epoch_freq, empty_freq, collect);
+			tracker = make<WFETracker>(task_num, slot_num, epoch_freq, empty_freq, collect);
 			type = WFE;
 		} else if (tracker_type == "HR"){
-			tracker = new HRTracker<T>(task_num, slot_num, epoch_freq, empty_freq, collect);
+			tracker = make<HRTracker>(task_num, slot_num, epoch_freq, empty_freq, collect);
 			type = HR;
+		} else if (tracker_type == "HRAsym"){
+			tracker = make<HRTracker>(task_num, slot_num, epoch_freq, empty_freq, fence_asym, collect);
+			type = HRAsym;
 		} else if (tracker_type == "WFR"){
-			tracker = new WFRTracker<T>(task_num, slot_num, epoch_freq, empty_freq, collect);
+			tracker = make<WFRTracker>(task_num, slot_num, epoch_freq, empty_freq, collect);
 			type = WFR;
+		} else if (tracker_type == "NBR"){
+			tracker = make<NBRTracker>(task_num, slot_num, empty_freq, collect);
+			type = NBR;
 		} else if (tracker_type == "QSBR"){
-			tracker = new RCUTracker<T>(task_num, epoch_freq, empty_freq, type_QSBR, collect);
+			tracker = make<RCUTracker>(task_num, epoch_freq, empty_freq, type_QSBR, collect);
 			type = QSBR;
+		} else if (tracker_type == "DEBRA"){
+			tracker = make<DEBRATracker>(task_num, collect);
+			type = DEBRA;
 		} else if (tracker_type == "Interval"){
-			tracker = new IntervalTracker<T>(task_num, epoch_freq, empty_freq, collect);
+			tracker = make<IntervalTracker>(task_num, epoch_freq, empty_freq, collect);
 			type = Interval;
+		} else if (tracker_type == "IntervalSort"){
+			tracker = make<IntervalTracker>(task_num, epoch_freq, empty_freq, scan_sorted, collect);
+			type = IntervalSort;
 		}
 		
 		// only compile in 32 bit mode
 #if !(__x86_64__ || __ppc64__)
 		else if (tracker_type == "TP"){
-			tracker = new RangeTrackerTP<T>(task_num, epoch_freq, empty_freq, collect);
+			tracker = make<RangeTrackerTP>(task_num, epoch_freq, empty_freq, collect);
 			type = Range_TP;
 		}
 #endif
@@ -184,12 +386,84 @@ public:
 		else {
 			errexit("constructor - tracker type error.");
 		}
+
+		tracker->init_node_extra(max_extra);
+		if (typed){
+			tracker->init_typed();
+		}
+		tracker->build_node_pool();
+		tracker->init_pooled_tids(gtc->task_num + gtc->task_stall);
+
+		if (gtc->checkEnv("free_budget") && type != NIL){
+			tracker->init_free_budget(atoi((gtc->getEnv("free_budget")).c_str()));
+		}
+
+		// NIL has no per-node header to chain reclaimed nodes through.
+		if (gtc->checkEnv("reclaimers") && type != NIL){
+			tracker->init_reclaimer(gtc, atoi((gtc->getEnv("reclaimers")).c_str()));
+		}
+
+		if (!domain.empty()){
+			shared = new Domain{tracker, std::type_index(typeid(T)), type, slot_num,
+				max_extra, typed, epoch_freq, empty_freq, collect, 1, new padded<int>[task_num]};
+			for (int i = 0; i < task_num; i++){
+				shared->left[i].ui = 0;
+			}
+			domains()[domain] = shared;
+		}
 		
 		
 	}
 
+	// Every rideable of a shared domain calls this for each thread;
+	// the tracker acts on the last of those calls.
 	void lastExit(int tid) {
+		if (shared != NULL){
+			if (++shared->left[tid].ui < shared->attached)
+				return;
+			shared->left[tid].ui = 0;
+		}
 		tracker->last_end_op(tid);
+		tracker->flush_pending();
+		tracker->exit_reclaimer();
+	}
+
+	// Borrows a free pooled tid for a thread joining mid-run (-1 if
+	// none, e.g. without -dpool_threads).
+	int registerThread() {
+		return tracker->register_thread();
+	}
+
+	// Gives tid back once the thread is done: its reservations are
+	// dropped, its retired nodes scanned, and any nodes it had queued
+	// for freeing are released before the tid can be reused.
+	// Rideables of a shared domain hand out tids from one tracker, so
+	// only the first call for a borrowed tid does anything.
+	void unregisterThread(int tid) {
+		if (!tracker->unregister_thread(tid))
+			return;
+		tracker->flush_pending();
+		tracker->flush_reclaimer();
+	}
+
+	uint64_t scanCount(int tid) {
+		return tracker->get_scan_cnt(tid);
+	}
+
+	uint64_t scanTime(int tid) {
+		return tracker->get_scan_ns(tid);
+	}
+
+	size_t metaBytes() {
+		return tracker->get_meta_bytes();
+	}
+
+	uint64_t reclaimerTime() {
+		return tracker->get_reclaimer_ns();
+	}
+
+	const void* domain() {
+		return tracker;
 	}
 
 	void* alloc(){
@@ -199,6 +473,20 @@ public:
 	void* alloc(int tid){
 		return tracker->alloc(tid);
 	}
+
+	// A node with extra bytes after the tracker's header, see node_extra().
+	void* alloc(int tid, size_t extra){
+		return tracker->alloc(tid, extra);
+	}
+
+	void* node_extra(T* obj){
+		return tracker->node_extra(obj);
+	}
+
+	// A node of a typed tracker destroyed by del instead of ~T().
+	void* alloc(int tid, size_t extra, typename BaseTracker<T>::Deleter del){
+		return tracker->alloc(tid, extra, del);
+	}
 	//NOTE: reclaim shall be only used to thread-local objects.
 	void reclaim(T* obj){
 		if(obj!=nullptr)
@@ -212,11 +500,13 @@ public:
 
 	void start_op(int tid){
 		//tracker->inc_opr(tid);
+		tracker->drain_pending();
 		tracker->start_op(tid);
 	}
 
 	void end_op(int tid){
 		tracker->end_op(tid);
+		tracker->drain_pending();
 	}
 
 	T* read(std::atomic<T*>& obj, int idx, int tid, T* node){
@@ -241,11 +531,41 @@ public:
 		tracker->clear_all(tid);
 	}
 
+	// Read phases, see TRACKER_READ_PHASE. Only NBR has them; for
+	// the other trackers these compile to a predictable branch.
+	bool neutralized(){
+		return type == NBR;
+	}
+
+	sigjmp_buf* read_checkpoint(int tid){
+		return tracker->read_checkpoint(tid);
+	}
+
+	void begin_read(int tid){
+		if (type == NBR)
+			tracker->begin_read(tid);
+	}
+
+	// Ends the read phase; keep are the nodes the write phase uses.
+	template<typename... Ptrs>
+	void end_read(int tid, Ptrs... keep){
+		if (type == NBR){
+			T* nodes[] = {keep...};
+			tracker->end_read(tid, nodes, sizeof...(keep));
+		}
+	}
+
 	void retire(T* obj, int tid){
 		tracker->inc_retired(tid);
 		tracker->retire(obj, tid);
 	}
 
+	// Retires obj of a typed tracker with the deleter that will free it.
+	void retire(T* obj, int tid, typename BaseTracker<T>::Deleter del){
+		tracker->set_deleter(obj, del);
+		retire(obj, tid);
+	}
+
 	uint64_t get_retired_cnt(int tid){
 		if (type){
 			return tracker->get_retired_cnt(tid);
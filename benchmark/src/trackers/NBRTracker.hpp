@@ -0,0 +1,293 @@
+/*
+
+Copyright 2017 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+
+#ifndef NBR_TRACKER_HPP
+#define NBR_TRACKER_HPP
+
+#ifndef _REENTRANT
+#define _REENTRANT
+#endif
+
+#include <atomic>
+#include <algorithm>
+#include <functional>
+#include <pthread.h>
+#include <sched.h>
+#include <setjmp.h>
+#include <signal.h>
+#include "ConcurrentPrimitives.hpp"
+#include "RAllocator.hpp"
+
+#include "BaseTracker.hpp"
+
+#define NBR_SIGNAL	SIGUSR1
+
+// What the signal handler needs to know about a thread, one per tid
+// of every NBR tracker.
+struct alignas(128) NBRThread {
+	sigjmp_buf env;
+	std::atomic<bool> restartable;
+	std::atomic<uint64_t> ack;	// bumped by every handled signal
+	std::atomic<uint64_t> seq;	// odd while in an operation
+	std::atomic<int> signalers;	// reclaimers about to pthread_kill
+	pthread_t self;
+};
+
+// The NBRThread of the calling thread's current (or last) operation.
+inline NBRThread*& nbr_self(){
+	static thread_local NBRThread* self __attribute__((tls_model("initial-exec"))) = NULL;
+	return self;
+}
+
+// Neutralizes the thread: a read phase goes back to its checkpoint,
+// a write phase goes on and is protected by its reservations.
+inline void nbr_handler(int sig){
+	NBRThread* t = nbr_self();
+	if (t == NULL)
+		return;
+	bool restart = t->restartable.load(std::memory_order_relaxed);
+	t->ack.fetch_add(1, std::memory_order_release);
+	if (restart){
+		t->restartable.store(false, std::memory_order_relaxed);
+		siglongjmp(t->env, 1);
+	}
+}
+
+template<class T>
+class NBRTracker: public BaseTracker<T>{
+private:
+	int task_num;
+	int slotsPerThread;
+	int bag;
+	bool collect;
+
+public:
+	struct NBRInfo {
+		struct NBRInfo* next;
+	};
+
+private:
+	NBRThread* threads;
+	SlotArray<std::atomic<T*>> slots;
+	padded<NBRInfo*>* retired;
+	padded<int>* cntrs;
+	padded<T**>* snapshots;
+	padded<uint64_t*>* sent;
+
+	static inline T* strip(T* ptr){
+		return (T*)((size_t)ptr & 0xfffffffffffffffc);
+	}
+
+	// Signals every other thread that is in an operation and waits
+	// until each has handled it or moved on to another operation.
+	void neutralize(int tid){
+		uint64_t* s = sent[tid].ui;
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		for (int i = 0; i < task_num; i++){
+			s[2*i] = 0;
+			if (i == tid)
+				continue;
+			NBRThread* t = &threads[i];
+			t->signalers.fetch_add(1, std::memory_order_seq_cst);
+			uint64_t seq = t->seq.load(std::memory_order_seq_cst);
+			if (seq & 1){
+				s[2*i] = seq;
+				s[2*i+1] = t->ack.load(std::memory_order_acquire);
+				pthread_kill(t->self, NBR_SIGNAL);
+			}
+			t->signalers.fetch_sub(1, std::memory_order_release);
+		}
+		for (int i = 0; i < task_num; i++){
+			if (s[2*i] == 0)
+				continue;
+			NBRThread* t = &threads[i];
+			while (t->ack.load(std::memory_order_acquire) == s[2*i+1] &&
+				t->seq.load(std::memory_order_acquire) == s[2*i])
+				sched_yield();
+		}
+	}
+
+	// Neutralizes the others and frees the retired nodes that no
+	// reservation covers, checked against a sorted snapshot.
+	void empty(int tid){
+		NBRInfo** field = &(retired[tid].ui);
+		NBRInfo* info = *field;
+		if (info == nullptr) return;
+		neutralize(tid);
+		T** snap = snapshots[tid].ui;
+		int cnt = 0;
+		for (int i = 0; i < task_num; i++){
+			for (int j = 0; j < slotsPerThread; j++){
+				T* ptr = slots[i][j].load(std::memory_order_acquire);
+				if (ptr != NULL) snap[cnt++] = ptr;
+			}
+		}
+		std::sort(snap, snap + cnt, std::less<T*>());
+		do {
+			NBRInfo* curr = info;
+			info = curr->next;
+			auto ptr = (T*)curr - 1;
+			if (!std::binary_search(snap, snap + cnt, ptr, std::less<T*>())){
+				*field = info;
+				this->reclaim(ptr);
+				this->dec_retired(tid);
+				continue;
+			}
+			field = &curr->next;
+		} while (info != nullptr);
+	}
+
+public:
+	~NBRTracker(){};
+	NBRTracker(int task_num, int slotsPerThread, int emptyFreq, bool collect):BaseTracker<T>(task_num){
+		this->task_num = task_num;
+		this->slotsPerThread = slotsPerThread;
+		this->bag = emptyFreq * task_num;
+		this->collect = collect;
+		threads = (NBRThread*) memalign(alignof(NBRThread), sizeof(NBRThread) * task_num);
+		slots.init(task_num, slotsPerThread);
+		retired = new padded<NBRInfo*>[task_num];
+		cntrs = new padded<int>[task_num];
+		snapshots = new padded<T**>[task_num];
+		sent = new padded<uint64_t*>[task_num];
+		for (int i = 0; i < task_num; i++){
+			threads[i].restartable.store(false, std::memory_order_relaxed);
+			threads[i].ack.store(0, std::memory_order_relaxed);
+			threads[i].seq.store(0, std::memory_order_relaxed);
+			threads[i].signalers.store(0, std::memory_order_relaxed);
+			for (int j = 0; j < slotsPerThread; j++){
+				slots[i][j].store(NULL, std::memory_order_relaxed);
+			}
+			retired[i].ui = nullptr;
+			cntrs[i] = 0;
+			snapshots[i].ui = new T*[task_num * slotsPerThread];
+			sent[i].ui = new uint64_t[2 * task_num];
+		}
+		// one handler for the process, shared by all NBR trackers
+		static bool installed = false;
+		if (!installed){
+			struct sigaction sa;
+			sa.sa_handler = nbr_handler;
+			sigemptyset(&sa.sa_mask);
+			sa.sa_flags = SA_NODEFER | SA_RESTART;
+			if (sigaction(NBR_SIGNAL, &sa, NULL) != 0)
+				errexit("NBRTracker - cannot install the signal handler.");
+			installed = true;
+		}
+		this->add_meta_bytes(sizeof(NBRThread) * task_num + slots.bytes() +
+			(sizeof(padded<NBRInfo*>) + sizeof(padded<int>) +
+			 sizeof(padded<T**>) + sizeof(T*) * task_num * slotsPerThread +
+			 sizeof(padded<uint64_t*>) + sizeof(uint64_t) * 2 * task_num) * task_num);
+		this->init_node_pool(sizeof(T) + sizeof(NBRInfo));
+	}
+
+	void start_op(int tid){
+		NBRThread* t = &threads[tid];
+		t->self = pthread_self();
+		nbr_self() = t;
+		t->seq.store(t->seq.load(std::memory_order_relaxed) + 1, std::memory_order_seq_cst);
+	}
+	void end_op(int tid){
+		NBRThread* t = &threads[tid];
+		t->restartable.store(false, std::memory_order_relaxed);
+		t->seq.store(t->seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	sigjmp_buf* read_checkpoint(int tid){
+		return &threads[tid].env;
+	}
+	void begin_read(int tid){
+		threads[tid].restartable.store(true, std::memory_order_relaxed);
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+	}
+	// The handler runs on this thread, so program order is enough to
+	// have the reservations in place before the phase becomes writable.
+	void end_read(int tid, T* const* keep, int n){
+		assert(n <= slotsPerThread);
+		for (int i = 0; i < n; i++){
+			slots[tid][i].store(strip(keep[i]), std::memory_order_relaxed);
+		}
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+		threads[tid].restartable.store(false, std::memory_order_relaxed);
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+	}
+
+	// Outside a read phase (and in rideables without read phases)
+	// reservations work as hazard pointers.
+	T* read(std::atomic<T*>& obj, int idx, int tid, T* node){
+		if (threads[tid].restartable.load(std::memory_order_relaxed))
+			return obj.load(std::memory_order_acquire);
+		T* ret;
+		while(true){
+			ret = obj.load(std::memory_order_acquire);
+			slots[tid][idx].store(strip(ret), std::memory_order_seq_cst);
+			if (ret == obj.load(std::memory_order_acquire)){
+				return ret;
+			}
+		}
+	}
+	void reserve_slot(T* ptr, int slot, int tid, T* node){
+		if (!threads[tid].restartable.load(std::memory_order_relaxed))
+			slots[tid][slot].store(strip(ptr), std::memory_order_seq_cst);
+	}
+	void release(int slot, int tid){
+		slots[tid][slot].store(NULL, std::memory_order_release);
+	}
+	void clear_all(int tid){
+		for (int i = 0; i < slotsPerThread; i++){
+			slots[tid][i].store(NULL, std::memory_order_release);
+		}
+	}
+
+	// A reclaimer that saw this tid in an operation may still be
+	// about to signal the thread; wait for it before the thread exits.
+	void thread_exit(int tid){
+		clear_all(tid);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		while (threads[tid].signalers.load(std::memory_order_acquire) != 0)
+			sched_yield();
+		if (nbr_self() == &threads[tid])
+			nbr_self() = NULL;
+		if (collect) empty(tid);
+	}
+
+	void* alloc(int tid){
+		return (void*)this->node_alloc(sizeof(T)+sizeof(NBRInfo));
+	}
+
+	void retire(T* ptr, int tid){
+		if (ptr==NULL){return;}
+		NBRInfo** field = &(retired[tid].ui);
+		NBRInfo* info = (NBRInfo*) (ptr + 1);
+		info->next = *field;
+		*field = info;
+		if (collect && ++cntrs[tid].ui >= bag){
+			cntrs[tid].ui = 0;
+			auto start = std::chrono::steady_clock::now();
+			empty(tid);
+			this->add_scan_time(start, tid);
+		}
+	}
+
+	bool collecting(){return collect;}
+};
+
+
+#endif
@@ -0,0 +1,200 @@
+/*
+
+Copyright 2017 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. 
+
+*/
+
+
+#ifndef NODE_POOL_HPP
+#define NODE_POOL_HPP
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+#include <malloc.h>
+#include "ConcurrentPrimitives.hpp"
+#include "HarnessUtils.hpp"
+#include "dcas.hpp"
+
+#define MAX_POOL_THREADS	1024
+#define POOL_GROUP_SIZE		64
+
+extern int slab_alloc;
+
+// Per-thread slab allocator for tracker nodes (T plus the tracker's
+// header), enabled by -dalloc=slab. It follows BlockPool: each thread
+// allocates from and frees to its own list, and frees beyond
+// 2*POOL_GROUP_SIZE are returned as a group to a global stack, from
+// which threads with an empty list take whole groups. Unlike
+// BlockPool, the block size is chosen at run time and the global
+// stack is ABA-tagged with a double-width CAS (cptr only holds 32-bit
+// pointers).
+//
+// Nodes are freed from scans and Hyaline callbacks that do not know
+// the harness tid, so threads are numbered on their first use of any
+// pool instead. The number is returned when the thread exits and
+// handed to the next new thread, which takes over its lists.
+class NodePool{
+private:
+	struct Block {
+		Block* next;
+		Block* next_group;
+	};
+
+	struct Head {
+		Block* top;
+		Block* nth; // first block beyond POOL_GROUP_SIZE, if any
+		size_t count;
+		alignas(128) char pad[0];
+	};
+
+	union GroupTop {
+		struct {
+			Block* ptr;
+			uint64_t tag;
+		};
+		__uint128_t full;
+	};
+
+	size_t size;
+	std::atomic<Head*>* heads;
+	alignas(16) std::atomic<__uint128_t> global;
+
+	Head* my_head(){
+		int id = thread_id();
+		if (id >= MAX_POOL_THREADS)
+			errexit("NodePool - too many threads.");
+		Head* hn = heads[id].load(std::memory_order_relaxed);
+		if (hn == NULL){
+			hn = (Head*) memalign(alignof(Head), sizeof(Head));
+			hn->top = hn->nth = NULL;
+			hn->count = 0;
+			heads[id].store(hn, std::memory_order_relaxed);
+		}
+		return hn;
+	}
+
+	void append_group(Head* hn){
+		char* array = (char*) memalign(128, size * POOL_GROUP_SIZE);
+		for (int i = 0; i < POOL_GROUP_SIZE - 1; i++){
+			((Block*)(array + i * size))->next = (Block*)(array + (i + 1) * size);
+		}
+		((Block*)(array + (POOL_GROUP_SIZE - 1) * size))->next = NULL;
+		hn->top = (Block*) array;
+		hn->count = POOL_GROUP_SIZE;
+	}
+
+public:
+	struct ThreadId {
+		int id;
+		static std::mutex& lock(){
+			static std::mutex m;
+			return m;
+		}
+		static std::vector<int>& free_ids(){
+			static std::vector<int> ids;
+			return ids;
+		}
+		ThreadId(){
+			static int next_id = 0;
+			std::lock_guard<std::mutex> guard(lock());
+			if (free_ids().empty()){
+				id = next_id++;
+			} else {
+				id = free_ids().back();
+				free_ids().pop_back();
+			}
+		}
+		~ThreadId(){
+			std::lock_guard<std::mutex> guard(lock());
+			free_ids().push_back(id);
+		}
+	};
+
+	// Dense per-thread index shared by all pools (and Reclaimer).
+	static int thread_id(){
+		static thread_local ThreadId tid;
+		return tid.id;
+	}
+
+	NodePool(size_t block_size){
+		// keep blocks 16-byte aligned like malloc does
+		size = (block_size < sizeof(Block) ? sizeof(Block) : block_size);
+		size = (size + 15) & ~(size_t)15;
+		heads = new std::atomic<Head*>[MAX_POOL_THREADS];
+		for (int i = 0; i < MAX_POOL_THREADS; i++){
+			heads[i].store(NULL, std::memory_order_relaxed);
+		}
+		GroupTop empty;
+		empty.ptr = NULL;
+		empty.tag = 0;
+		global.store(empty.full, std::memory_order_relaxed);
+	}
+
+	void* alloc(){
+		Head* hn = my_head();
+		Block* b = hn->top;
+		if (b == NULL){
+			// local list is empty: take a group from the global stack
+			GroupTop old, grp;
+			old.full = dcas_load(global, std::memory_order_acquire);
+			do {
+				if (old.ptr == NULL) break;
+				grp.ptr = old.ptr->next_group;
+				grp.tag = old.tag + 1;
+			} while (!dcas_compare_exchange_weak(global, old.full, grp.full,
+					std::memory_order_acq_rel, std::memory_order_acquire));
+			if (old.ptr != NULL){
+				hn->top = old.ptr;
+				hn->count = POOL_GROUP_SIZE;
+			} else {
+				append_group(hn);
+			}
+			b = hn->top;
+		}
+		hn->top = b->next;
+		hn->count--;
+		if (b == hn->nth) hn->nth = NULL;
+		return (void*) b;
+	}
+
+	void free(void* ptr){
+		Head* hn = my_head();
+		Block* b = (Block*) ptr;
+		b->next = hn->top;
+		hn->top = b;
+		hn->count++;
+		if (hn->count == POOL_GROUP_SIZE + 1){
+			hn->nth = hn->top;
+		} else if (hn->count == POOL_GROUP_SIZE * 2){
+			// return the oldest POOL_GROUP_SIZE blocks as one group
+			Block* ng = hn->nth->next;
+			GroupTop old, grp;
+			old.full = dcas_load(global, std::memory_order_acquire);
+			do {
+				ng->next_group = old.ptr;
+				grp.ptr = ng;
+				grp.tag = old.tag + 1;
+			} while (!dcas_compare_exchange_weak(global, old.full, grp.full,
+					std::memory_order_acq_rel, std::memory_order_acquire));
+			hn->nth->next = NULL;
+			hn->nth = NULL;
+			hn->count -= POOL_GROUP_SIZE;
+		}
+	}
+};
+
+#endif
@@ -40,6 +40,7 @@ private:
 	int epochFreq;
 	bool collect;
 	RCUType type;
+	FenceType fence;
 	
 public:
 	struct RCUInfo {
@@ -57,8 +58,10 @@ private:
 
 public:
 	~RCUTracker(){};
-	RCUTracker(int task_num, int epochFreq, int emptyFreq, RCUType type, bool collect): 
-	 BaseTracker<T>(task_num),task_num(task_num),freq(emptyFreq),epochFreq(epochFreq),collect(collect),type(type){
+	RCUTracker(int task_num, int epochFreq, int emptyFreq, RCUType type, FenceType fence, bool collect): 
+	 BaseTracker<T>(task_num),task_num(task_num),freq(emptyFreq),epochFreq(epochFreq),collect(collect),type(type),fence(fence){
+		if (fence == fence_asym)
+			asym_fence_init();
 		retired = new padded<RCUInfo *>[task_num];
 		reservations = new paddedAtomic<uint64_t>[task_num];
 		retire_counters = new padded<uint64_t>[task_num];
@@ -68,7 +71,12 @@ public:
 			retired[i].ui = nullptr;
 		}
 		epoch.ui.store(0,std::memory_order_release);
+		this->add_meta_bytes((sizeof(padded<RCUInfo*>) + sizeof(paddedAtomic<uint64_t>) +
+			2 * sizeof(padded<uint64_t>)) * task_num);
+		this->init_node_pool(sizeof(T) + sizeof(RCUInfo));
 	}
+	RCUTracker(int task_num, int epochFreq, int emptyFreq, RCUType type, bool collect) : 
+		RCUTracker(task_num,epochFreq,emptyFreq,type,fence_seq_cst,collect){}
 	RCUTracker(int task_num, int epochFreq, int emptyFreq) : RCUTracker(task_num,epochFreq,emptyFreq,type_RCU,true){}
 	RCUTracker(int task_num, int epochFreq, int emptyFreq, bool collect) : 
 		RCUTracker(task_num,epochFreq,emptyFreq,type_RCU,collect){}
@@ -82,12 +90,17 @@ public:
 		if(alloc_counters[tid]%(epochFreq*task_num)==0){
 			epoch.ui.fetch_add(1,std::memory_order_acq_rel);
 		}
-		return (void*)malloc(sizeof(T)+sizeof(RCUInfo));
+		return (void*)this->node_alloc(sizeof(T)+sizeof(RCUInfo));
 	}
 	void start_op(int tid){
 		if (type == type_RCU){
 			uint64_t e = epoch.ui.load(std::memory_order_acquire);
-			reservations[tid].ui.store(e,std::memory_order_seq_cst);
+			if (fence == fence_asym){
+				reservations[tid].ui.store(e,std::memory_order_release);
+				asym_light_fence();
+			} else {
+				reservations[tid].ui.store(e,std::memory_order_seq_cst);
+			}
 		}
 		
 	}
@@ -131,6 +144,8 @@ public:
 
 	void empty(int tid) {
 		uint64_t minEpoch = UINT64_MAX;
+		if (fence == fence_asym)
+			asym_heavy_fence();
 		for (int i = 0; i<task_num; i++){
 			uint64_t res = reservations[i].ui.load(std::memory_order_acquire);
 			if(res<minEpoch){
@@ -153,6 +168,13 @@ public:
 			field = &curr->next;
 		}
 	}
+
+	void thread_exit(int tid){
+		// QSBR's end_op leaves a quiescent epoch, which would hold back
+		// reclamation once the thread is gone
+		reservations[tid].ui.store(UINT64_MAX,std::memory_order_seq_cst);
+		if (collect) empty(tid);
+	}
 		
 	bool collecting(){return collect;}
 	
@@ -69,6 +69,9 @@ public:
 		retire_counters = new padded<uint64_t>[task_num];
 		alloc_counters = new padded<uint64_t>[task_num];
 		epoch.ui.store(0,std::memory_order_release);
+		this->add_meta_bytes((sizeof(padded<IntervalInfo*>) + 2 * sizeof(paddedAtomic<uint64_t>) +
+			2 * sizeof(padded<uint64_t>)) * task_num);
+		this->init_node_pool(sizeof(T) + sizeof(IntervalInfo));
 	}
 	RangeTrackerNew(int task_num, int epochFreq, int emptyFreq) : RangeTrackerNew(task_num,epochFreq,emptyFreq,true){}
 
@@ -84,7 +87,7 @@ public:
 		if(alloc_counters[tid]%(epochFreq*task_num)==0){
 			epoch.ui.fetch_add(1,std::memory_order_acq_rel);
 		}
-		char* block = (char*) malloc(sizeof(IntervalInfo) + sizeof(T));
+		char* block = (char*) this->node_alloc(sizeof(IntervalInfo) + sizeof(T));
 		IntervalInfo* info = (IntervalInfo*) (block + sizeof(T));
 		info->birth_epoch = get_epoch();
 		return (void*)block;
@@ -95,11 +98,6 @@ public:
 		return info->birth_epoch;
 	}
 
-	void reclaim(T* obj){
-		obj->~T();
-		free ((char*)obj);
-	}
-
 	T* read(std::atomic<T*>& obj, int idx, int tid, T* node){
 		return read(obj, tid);
 	}
@@ -171,6 +169,11 @@ public:
 	void retire(T* obj, int tid){
 		retire(obj, read_birth(obj), tid);
 	}
+
+	void thread_exit(int tid){
+		clear(tid);
+		if (collect) empty(tid);
+	}
 	
 	bool conflict(uint64_t* lower_epochs, uint64_t* upper_epochs, uint64_t birth_epoch, uint64_t retire_epoch){
 		for (int i = 0; i < task_num; i++){
@@ -199,7 +202,7 @@ public:
 			info = curr->next;
 			if(!conflict(lower_epochs_arr, upper_epochs_arr, curr->birth_epoch, curr->retire_epoch)){
 				*field = info;
-				reclaim((T*)curr - 1);
+				this->reclaim((T*)curr - 1);
 				this->dec_retired(tid);
 				continue;
 			}
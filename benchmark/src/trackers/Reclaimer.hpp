@@ -0,0 +1,217 @@
+/*
+
+Copyright 2017 University of Rochester
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. 
+
+*/
+
+
+#ifndef RECLAIMER_HPP
+#define RECLAIMER_HPP
+
+#include <atomic>
+#include <malloc.h>
+#include <pthread.h>
+#include <time.h>
+#include <hwloc.h>
+#include "ConcurrentPrimitives.hpp"
+#include "TestConfig.hpp"
+#include "NodePool.hpp"
+
+#define RECLAIM_BATCH	32
+
+template<class T> class BaseTracker;
+
+// Background reclaimer threads (-dreclaimers=N). A worker that would
+// destroy and free a node chains it into a per-thread batch instead;
+// full batches are pushed with one CAS onto the queue of one of the
+// reclaimers (a lock-free MPSC stack, drained with an exchange).
+// Reclaimers are pinned to the CPUs following the workers' and report
+// their CPU time separately. When the last worker leaves the run (or
+// the tracker is destroyed) they are stopped and joined, and drain
+// their queues one last time.
+//
+// The link is kept in the first word of the tracker header that
+// follows T, which is no longer used once a node is reclaimed.
+template<class T> class Reclaimer{
+private:
+	struct alignas(128) Batch {
+		T* first;
+		T* last;
+		int count;
+	};
+
+	struct alignas(128) Queue {
+		std::atomic<T*> head;
+		pthread_t thread;
+		uint64_t cpu_ns;	// set by the thread as it exits
+	};
+
+	struct Start {
+		Reclaimer<T>* self;
+		int idx;
+	};
+
+	BaseTracker<T>* tracker;
+	GlobalTestConfig* gtc;
+	int num;
+	Queue* queues;
+	Batch* batches;
+	std::atomic<bool> stop;
+	std::atomic<bool> stopping;
+	std::atomic<bool> joined;
+	std::atomic<int> exits;
+
+	static inline T*& link(T* obj){
+		return *(T**)(obj + 1);
+	}
+
+	void drain(int idx){
+		T* obj = queues[idx].head.exchange(NULL, std::memory_order_acquire);
+		while (obj != NULL){
+			T* next = link(obj);
+			tracker->destroy(obj);
+			obj = next;
+		}
+	}
+
+	static void* run(void* arg){
+		Start* start = (Start*) arg;
+		Reclaimer<T>* self = start->self;
+		int idx = start->idx;
+		delete start;
+		GlobalTestConfig* gtc = self->gtc;
+		int cpu = (gtc->task_num + gtc->task_stall + idx) % gtc->affinities.size();
+		hwloc_set_cpubind(gtc->topology, gtc->affinities[cpu]->cpuset, HWLOC_CPUBIND_THREAD);
+		while (!self->stop.load(std::memory_order_acquire)){
+			if (self->queues[idx].head.load(std::memory_order_relaxed) == NULL){
+				struct timespec idle = {0, 50000};
+				nanosleep(&idle, NULL);
+				continue;
+			}
+			self->drain(idx);
+		}
+		self->drain(idx);
+		struct timespec ts;
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+		self->queues[idx].cpu_ns = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+		return NULL;
+	}
+
+public:
+	Reclaimer(BaseTracker<T>* tracker, GlobalTestConfig* gtc, int num):
+	 tracker(tracker), gtc(gtc), num(num){
+		stop.store(false, std::memory_order_relaxed);
+		stopping.store(false, std::memory_order_relaxed);
+		joined.store(false, std::memory_order_relaxed);
+		exits.store(0, std::memory_order_relaxed);
+		queues = (Queue*) memalign(alignof(Queue), sizeof(Queue) * num);
+		batches = (Batch*) memalign(alignof(Batch), sizeof(Batch) * MAX_POOL_THREADS);
+		for (int i = 0; i < MAX_POOL_THREADS; i++){
+			batches[i].first = batches[i].last = NULL;
+			batches[i].count = 0;
+		}
+		for (int i = 0; i < num; i++){
+			queues[i].head.store(NULL, std::memory_order_relaxed);
+			queues[i].cpu_ns = 0;
+		}
+		for (int i = 0; i < num; i++){
+			Start* start = new Start{this, i};
+			if (pthread_create(&queues[i].thread, NULL, run, start) != 0)
+				errexit("Reclaimer - pthread_create failed.");
+		}
+	}
+
+	~Reclaimer(){
+		shutdown();
+	}
+
+	void push(T* obj){
+		if (stop.load(std::memory_order_acquire)){
+			tracker->destroy(obj);
+			return;
+		}
+		int id = NodePool::thread_id();
+		if (id >= MAX_POOL_THREADS)
+			errexit("Reclaimer - too many threads.");
+		Batch* b = &batches[id];
+		link(obj) = b->first;
+		b->first = obj;
+		if (b->last == NULL) b->last = obj;
+		if (++b->count == RECLAIM_BATCH)
+			flush();
+	}
+
+	// Hands this thread's partial batch to a reclaimer.
+	void flush(){
+		flush(NodePool::thread_id());
+	}
+	void flush(int id){
+		Batch* b = &batches[id];
+		if (b->first == NULL) return;
+		std::atomic<T*>& head = queues[id % num].head;
+		T* old = head.load(std::memory_order_relaxed);
+		do {
+			link(b->last) = old;
+		} while (!head.compare_exchange_weak(old, b->first,
+				std::memory_order_release, std::memory_order_relaxed));
+		b->first = b->last = NULL;
+		b->count = 0;
+	}
+
+	// A worker is done with the run; the last of the task_num workers
+	// shuts the reclaimers down.
+	void worker_exit(){
+		flush();
+		if (exits.fetch_add(1, std::memory_order_acq_rel) + 1 == gtc->task_num)
+			shutdown();
+	}
+
+	// Stops and joins the reclaimer threads once no worker pushes
+	// nodes any more; each drains its queue before it exits. Nodes
+	// reclaimed afterwards are destroyed by the caller.
+	void shutdown(){
+		bool exp = false;
+		if (!stopping.compare_exchange_strong(exp, true, std::memory_order_acq_rel))
+			return;
+		for (int i = 0; i < MAX_POOL_THREADS; i++){
+			flush(i);
+		}
+		stop.store(true, std::memory_order_release);
+		for (int i = 0; i < num; i++){
+			pthread_join(queues[i].thread, NULL);
+		}
+		joined.store(true, std::memory_order_release);
+	}
+
+	// Total CPU time of all reclaimer threads, in nanoseconds.
+	uint64_t cpu_time(){
+		uint64_t total = 0;
+		for (int i = 0; i < num; i++){
+			if (joined.load(std::memory_order_acquire)){
+				total += queues[i].cpu_ns;
+				continue;
+			}
+			clockid_t cid;
+			struct timespec ts;
+			if (pthread_getcpuclockid(queues[i].thread, &cid) == 0 &&
+				clock_gettime(cid, &ts) == 0){
+				total += (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+			}
+		}
+		return total;
+	}
+};
+
+#endif
@@ -56,11 +56,10 @@ limitations under the License.
 #include "RAllocator.hpp"
 
 #include "BaseTracker.hpp"
+#include "IntervalScan.hpp"
 
 #include "dcas.hpp"
 
-#define MAX_WFE		16
-
 union word_pair_t {
 	std::atomic<uint64_t> pair[2];
 	std::atomic<__uint128_t> full;
@@ -86,14 +85,6 @@ private:
 	bool collect;
 
 public:
-	struct WFESlot {
-		word_pair_t slot[MAX_WFE];
-	};
-
-	struct WFEState {
-		state_t state[MAX_WFE];
-	};
-
 	struct WFEInfo {
 		struct WFEInfo* next;
 		uint64_t birth_epoch;
@@ -101,12 +92,12 @@ public:
 	};
 
 private:
-	WFESlot* reservations;
-	WFESlot* local_reservations;
-	WFEState* states;
+	SlotArray<word_pair_t> reservations;
+	SlotArray<state_t> states;
 	padded<uint64_t>* retire_counters;
 	padded<uint64_t>* alloc_counters;
 	padded<WFEInfo*>* retired;
+	padded<IntervalScan>* scans;
 	paddedAtomic<uint64_t> counter_start, counter_end;
 
 	paddedAtomic<uint64_t> epoch;
@@ -116,29 +107,38 @@ public:
 	WFETracker(int task_num, int he_num, int epochFreq, int emptyFreq, bool collect):
 	 BaseTracker<T>(task_num),task_num(task_num),he_num(he_num),epochFreq(epochFreq),freq(emptyFreq),collect(collect) {
 		retired = new padded<WFEInfo*>[task_num];
-		reservations = (WFESlot*) memalign(alignof(WFESlot), sizeof(WFESlot) * task_num);
-		states = (WFEState*) memalign(alignof(WFEState), sizeof(WFEState) * task_num);
-		local_reservations = (WFESlot*) memalign(alignof(WFESlot), sizeof(WFESlot) * task_num * task_num);
+		// he_num and he_num+1 are used for helping
+		reservations.init(task_num, he_num + 2);
+		states.init(task_num, he_num);
+		// per-thread snapshot of slots 0..he_num, reused by every scan
+		scans = new padded<IntervalScan>[task_num];
+		for (int i = 0; i<task_num; i++){
+			scans[i].ui.init(task_num * (he_num + 1));
+		}
 		for (int i = 0; i<task_num; i++){
 			retired[i].ui = nullptr;
 			for (int j = 0; j<he_num; j++){
-				states[i].state[j].result.pair[0] = 0;
-				states[i].state[j].result.pair[1] = 0;
-				states[i].state[j].pointer = 0;
-				states[i].state[j].epoch = 0;
-				reservations[i].slot[j].pair[0] = 0;
-				reservations[i].slot[j].pair[1] = 0;
+				states[i][j].result.pair[0] = 0;
+				states[i][j].result.pair[1] = 0;
+				states[i][j].pointer = 0;
+				states[i][j].epoch = 0;
+				reservations[i][j].pair[0] = 0;
+				reservations[i][j].pair[1] = 0;
 			}
-			reservations[i].slot[he_num].pair[0] = 0;
-			reservations[i].slot[he_num].pair[1] = 0;
-			reservations[i].slot[he_num+1].pair[0] = 0;
-			reservations[i].slot[he_num+1].pair[1] = 0;
+			reservations[i][he_num].pair[0] = 0;
+			reservations[i][he_num].pair[1] = 0;
+			reservations[i][he_num+1].pair[0] = 0;
+			reservations[i][he_num+1].pair[1] = 0;
 		}
 		retire_counters = new padded<uint64_t>[task_num];
 		alloc_counters = new padded<uint64_t>[task_num];
 		counter_start.ui.store(0, std::memory_order_release);
 		counter_end.ui.store(0, std::memory_order_release);
 		epoch.ui.store(1, std::memory_order_release); // use 0 as infinity
+		this->add_meta_bytes(reservations.bytes() + states.bytes() +
+			(sizeof(padded<uint64_t>) * 2 + sizeof(padded<WFEInfo*>) +
+			 sizeof(padded<IntervalScan>) + sizeof(uint64_t) * task_num * (he_num + 1)) * task_num);
+		this->init_node_pool(sizeof(T) + sizeof(WFEInfo));
 	}
 	WFETracker(int task_num, int emptyFreq) : WFETracker(task_num,emptyFreq,true){}
 
@@ -152,41 +152,41 @@ public:
 	inline void help_thread(int tid, int index, int mytid)
 	{
 		value_pair_t last_result;
-		last_result.full = dcas_load(states[tid].state[index].result.full, std::memory_order_acquire);
+		last_result.full = dcas_load(states[tid][index].result.full, std::memory_order_acquire);
 		if (last_result.pair[0] != (uint64_t) -1LL)
 			return;
-		uint64_t birth_epoch = states[tid].state[index].epoch.load(std::memory_order_acquire);
-		reservations[mytid].slot[he_num].pair[0].store(birth_epoch, std::memory_order_seq_cst);
-		std::atomic<T*> *obj = (std::atomic<T*> *) states[tid].state[index].pointer.load(std::memory_order_acquire);
-		uint64_t seqno = reservations[tid].slot[index].pair[1].load(std::memory_order_acquire);
+		uint64_t birth_epoch = states[tid][index].epoch.load(std::memory_order_acquire);
+		reservations[mytid][he_num].pair[0].store(birth_epoch, std::memory_order_seq_cst);
+		std::atomic<T*> *obj = (std::atomic<T*> *) states[tid][index].pointer.load(std::memory_order_acquire);
+		uint64_t seqno = reservations[tid][index].pair[1].load(std::memory_order_acquire);
 		if (last_result.pair[1] == seqno) {
 			uint64_t prev_epoch = getEpoch();
 			do {
-				reservations[mytid].slot[he_num+1].pair[0].store(prev_epoch, std::memory_order_seq_cst);
+				reservations[mytid][he_num+1].pair[0].store(prev_epoch, std::memory_order_seq_cst);
 				T* ptr = obj ? obj->load(std::memory_order_acquire) : nullptr;
 				uint64_t curr_epoch = getEpoch();
 				if (curr_epoch == prev_epoch) {
 					value_pair_t value;
 					value.pair[0] = (uint64_t) ptr;
 					value.pair[1] = curr_epoch;
-					if (dcas_compare_exchange_strong(states[tid].state[index].result.full, last_result.full, value.full, std::memory_order_acq_rel, std::memory_order_acquire)) {
+					if (dcas_compare_exchange_strong(states[tid][index].result.full, last_result.full, value.full, std::memory_order_acq_rel, std::memory_order_acquire)) {
 						value.pair[0] = curr_epoch;
 						value.pair[1] = seqno + 1;
 						value_pair_t old;
-						old.pair[1] = reservations[tid].slot[index].pair[1].load(std::memory_order_acquire);
-						old.pair[0] = reservations[tid].slot[index].pair[0].load(std::memory_order_acquire);
+						old.pair[1] = reservations[tid][index].pair[1].load(std::memory_order_acquire);
+						old.pair[0] = reservations[tid][index].pair[0].load(std::memory_order_acquire);
 						do { // 2 iterations at most
 							if (old.pair[1] != seqno)
 								break;
-						} while (!dcas_compare_exchange_weak(reservations[tid].slot[index].full, old.full, value.full, std::memory_order_acq_rel, std::memory_order_acquire));
+						} while (!dcas_compare_exchange_weak(reservations[tid][index].full, old.full, value.full, std::memory_order_acq_rel, std::memory_order_acquire));
 					}
 					break;
 				}
 				prev_epoch = curr_epoch;
-			} while (last_result.full == dcas_load(states[tid].state[index].result.full, std::memory_order_acquire));
-			reservations[mytid].slot[he_num+1].pair[0].store(0, std::memory_order_seq_cst);
+			} while (last_result.full == dcas_load(states[tid][index].result.full, std::memory_order_acquire));
+			reservations[mytid][he_num+1].pair[0].store(0, std::memory_order_seq_cst);
 		}
-		reservations[mytid].slot[he_num].pair[0].store(0, std::memory_order_seq_cst);
+		reservations[mytid][he_num].pair[0].store(0, std::memory_order_seq_cst);
 	}
 
 	inline void help_read(int mytid)
@@ -197,7 +197,7 @@ public:
 		if (cs - ce != 0) {
 			for (int i = 0; i < task_num; i++) {
 				for (int j = 0; j < he_num; j++) {
-					uint64_t result_ptr = states[i].state[j].result.pair[0].load(std::memory_order_acquire);
+					uint64_t result_ptr = states[i][j].result.pair[0].load(std::memory_order_acquire);
 					if (result_ptr == (uint64_t) -1LL) {
 						help_thread(i, j, mytid);
 					}
@@ -214,22 +214,16 @@ public:
 			// only after that increment the counter
 			epoch.ui.fetch_add(1,std::memory_order_acq_rel);
 		}
-		char* block = (char*) malloc(sizeof(WFEInfo) + sizeof(T));
+		char* block = (char*) this->node_alloc(sizeof(WFEInfo) + sizeof(T));
 		WFEInfo* info = (WFEInfo*) (block + sizeof(T));
 		info->birth_epoch = getEpoch();
 		return (void*)block;
 	}
 
-	void reclaim(T* obj)
-	{
-		obj->~T();
-		free ((char*)obj);
-	}
-
 	T* read(std::atomic<T*>& obj, int index, int tid, T* node)
 	{
 		// fast path
-		uint64_t prev_epoch = reservations[tid].slot[index].pair[0].load(std::memory_order_acquire);
+		uint64_t prev_epoch = reservations[tid][index].pair[0].load(std::memory_order_acquire);
 		size_t attempts = 16;
 		do {
 			T* ptr = obj.load(std::memory_order_acquire);
@@ -237,7 +231,7 @@ public:
 			if (curr_epoch == prev_epoch) {
 				return ptr;
 			} else {
-				reservations[tid].slot[index].pair[0].store(curr_epoch, std::memory_order_seq_cst);
+				reservations[tid][index].pair[0].store(curr_epoch, std::memory_order_seq_cst);
 				prev_epoch = curr_epoch;
 			}
 		} while (--attempts != 0);
@@ -247,14 +241,14 @@ public:
 
 	void reserve_slot(T* obj, int index, int tid, T* node){
 		// fast path
-		uint64_t prev_epoch = reservations[tid].slot[index].pair[0].load(std::memory_order_acquire);
+		uint64_t prev_epoch = reservations[tid][index].pair[0].load(std::memory_order_acquire);
 		size_t attempts = 16;
 		do {
 			uint64_t curr_epoch = getEpoch();
 			if (curr_epoch == prev_epoch){
 				return;
 			} else {
-				reservations[tid].slot[index].pair[0].store(curr_epoch, std::memory_order_seq_cst);
+				reservations[tid][index].pair[0].store(curr_epoch, std::memory_order_seq_cst);
 				prev_epoch = curr_epoch;
 			}
 		} while (--attempts != 0);
@@ -265,17 +259,17 @@ public:
 	__attribute__((noinline)) T* slow_path(std::atomic<T*>* obj, int index, int tid, T* node)
 	{
 		// slow path
-		uint64_t prev_epoch = reservations[tid].slot[index].pair[0].load(std::memory_order_acquire);
+		uint64_t prev_epoch = reservations[tid][index].pair[0].load(std::memory_order_acquire);
 		counter_start.ui.fetch_add(1, std::memory_order_acq_rel);
-		states[tid].state[index].pointer.store((uint64_t) obj, std::memory_order_release);
+		states[tid][index].pointer.store((uint64_t) obj, std::memory_order_release);
 		uint64_t birth_epoch = (node == nullptr) ? 0 :
 			((WFEInfo *)(node + 1))->birth_epoch;
-		states[tid].state[index].epoch.store(birth_epoch, std::memory_order_release);
-		uint64_t seqno = reservations[tid].slot[index].pair[1].load(std::memory_order_acquire);
+		states[tid][index].epoch.store(birth_epoch, std::memory_order_release);
+		uint64_t seqno = reservations[tid][index].pair[1].load(std::memory_order_acquire);
 		value_pair_t last_result;
 		last_result.pair[0] = (uint64_t) -1LL;
 		last_result.pair[1] = seqno;
-		dcas_store(states[tid].state[index].result.full, last_result.full, std::memory_order_release);
+		dcas_store(states[tid][index].result.full, last_result.full, std::memory_order_release);
 
 		uint64_t result_epoch, result_ptr;
 		do {
@@ -287,8 +281,8 @@ public:
 				last_result.pair[1] = seqno;
 				value.pair[0] = 0;
 				value.pair[1] = 0;
-				if (dcas_compare_exchange_strong(states[tid].state[index].result.full, last_result.full, value.full, std::memory_order_acq_rel, std::memory_order_acquire)) {
-					reservations[tid].slot[index].pair[1].store(seqno + 1, std::memory_order_release);
+				if (dcas_compare_exchange_strong(states[tid][index].result.full, last_result.full, value.full, std::memory_order_acq_rel, std::memory_order_acquire)) {
+					reservations[tid][index].pair[1].store(seqno + 1, std::memory_order_release);
 					counter_end.ui.fetch_add(1, std::memory_order_acq_rel);
 					return ptr;
 				}
@@ -297,14 +291,14 @@ public:
 			last_epoch.pair[1] = seqno;
 			value.pair[0] = curr_epoch;
 			value.pair[1] = seqno;
-			dcas_compare_exchange_strong(reservations[tid].slot[index].full, last_epoch.full, value.full, std::memory_order_seq_cst, std::memory_order_acquire);
+			dcas_compare_exchange_strong(reservations[tid][index].full, last_epoch.full, value.full, std::memory_order_seq_cst, std::memory_order_acquire);
 			prev_epoch = curr_epoch;
-			result_ptr = states[tid].state[index].result.pair[0].load(std::memory_order_acquire);
+			result_ptr = states[tid][index].result.pair[0].load(std::memory_order_acquire);
 		} while (result_ptr == (uint64_t) -1LL);
 
-		result_epoch = states[tid].state[index].result.pair[1].load(std::memory_order_acquire);
-		reservations[tid].slot[index].pair[0].store(result_epoch, std::memory_order_release);
-		reservations[tid].slot[index].pair[1].store(seqno + 1, std::memory_order_release);
+		result_epoch = states[tid][index].result.pair[1].load(std::memory_order_acquire);
+		reservations[tid][index].pair[0].store(result_epoch, std::memory_order_release);
+		reservations[tid][index].pair[1].store(seqno + 1, std::memory_order_release);
 		counter_end.ui.fetch_add(1, std::memory_order_acq_rel);
 
 		return (T*) result_ptr;
@@ -312,10 +306,15 @@ public:
 
 	void clear_all(int tid){
 		for (int i = 0; i < he_num; i++){
-			reservations[tid].slot[i].pair[0].store(0, std::memory_order_seq_cst);
+			reservations[tid][i].pair[0].store(0, std::memory_order_seq_cst);
 		}
 	}
 
+	void thread_exit(int tid){
+		clear_all(tid);
+		if (collect) empty(tid);
+	}
+
 	inline void incrementEpoch(){
 		epoch.ui.fetch_add(1, std::memory_order_acq_rel);
 	}
@@ -333,10 +332,10 @@ public:
 		retire_counters[tid]=retire_counters[tid]+1;
 	}
 	
-	bool can_delete(WFESlot* local, uint64_t birth_epoch, uint64_t retire_epoch, int js, int je) {
+	bool can_delete(uint64_t birth_epoch, uint64_t retire_epoch, int js, int je) {
 		for (int i = 0; i < task_num; i++){
 			for (int j = js; j < je; j++){
-				const uint64_t epo = local[i].slot[j].pair[0].load(std::memory_order_acquire);
+				const uint64_t epo = reservations[i][j].pair[0].load(std::memory_order_acquire);
 				if (epo < birth_epoch || epo > retire_epoch || epo == 0){
 					continue;
 				} else {
@@ -349,27 +348,30 @@ public:
 
 	void empty(int tid){
 		// erase safe objects
-		WFESlot* local = local_reservations + tid * task_num;
 		WFEInfo** field = &(retired[tid].ui);
 		WFEInfo* info = *field;
 		if (info == nullptr) return;
+		IntervalScan* local = &scans[tid].ui;
+		local->clear();
 		for (int i = 0; i < task_num; i++) {
 			for (int j = 0; j < he_num; j++) {
-				local[i].slot[j].pair[0].store(reservations[i].slot[j].pair[0].load(std::memory_order_acquire), std::memory_order_relaxed);
+				const uint64_t epo = reservations[i][j].pair[0].load(std::memory_order_acquire);
+				if (epo != 0) local->add(epo);
 			}
 		}
 		for (int i = 0; i < task_num; i++) {
-			local[i].slot[he_num].pair[0].store(reservations[i].slot[he_num].pair[0].load(std::memory_order_acquire), std::memory_order_relaxed);
+			const uint64_t epo = reservations[i][he_num].pair[0].load(std::memory_order_acquire);
+			if (epo != 0) local->add(epo);
 		}
 		do {
 			WFEInfo* curr = info;
 			info = curr->next;
 			uint64_t ce = counter_end.ui.load(std::memory_order_acquire);
-			if (can_delete(local, curr->birth_epoch, curr->retire_epoch, 0, he_num+1)) {
+			if (!local->conflict_linear(curr->birth_epoch, curr->retire_epoch)) {
 				uint64_t cs = counter_start.ui.load(std::memory_order_acquire);
-				if (ce == cs || (can_delete(reservations, curr->birth_epoch, curr->retire_epoch, he_num+1, he_num+2) && can_delete(reservations, curr->birth_epoch, curr->retire_epoch, 0, he_num))) {
+				if (ce == cs || (can_delete(curr->birth_epoch, curr->retire_epoch, he_num+1, he_num+2) && can_delete(curr->birth_epoch, curr->retire_epoch, 0, he_num))) {
 					*field = info;
-					reclaim((T*)curr - 1);
+					this->reclaim((T*)curr - 1);
 					this->dec_retired(tid);
 					continue;
 				}
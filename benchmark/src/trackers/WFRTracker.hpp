@@ -39,7 +39,6 @@
 
 #define WFR_INVPTR64	((uint64_t)-1LL)
 #define WFR_INVPTR		((WFRInfo*)-1LL)
-#define MAX_WFR			16
 #define MAX_WFRC		12
 #define WFR_PROTECT1	(1ULL << 63)
 #define WFR_PROTECT2	(1ULL << 62)
@@ -105,14 +104,14 @@ public:
 
 	struct WFRSlot {
 		// do not reorder
-		word_pair_t first[MAX_WFR];
-		word_pair_t epoch[MAX_WFR];
-		state_t state[MAX_WFR];
-		alignas(128) char _pad[0];
+		word_pair_t first;
+		word_pair_t epoch;
+		state_t state;
 	};
 
 private:
-	WFRSlot* slots;
+	SlotArray<WFRSlot> slots;
+	SlotArray<WFRInfo*> firsts;
 	WFRBatch* batches;
 	padded<uint64_t>* alloc_counters;
 	paddedAtomic<uint64_t> epoch;
@@ -123,7 +122,9 @@ public:
 	WFRTracker(int task_num, int hr_num, int epochFreq, int emptyFreq, bool collect): 
 	 BaseTracker<T>(task_num),task_num(task_num),hr_num(hr_num),epochFreq(task_num*epochFreq),freq(emptyFreq),collect(collect) {
 		batches = (WFRBatch*) memalign(alignof(WFRBatch), sizeof(WFRBatch) * task_num);
-		slots = (WFRSlot*) memalign(alignof(WFRSlot), sizeof(WFRSlot) * task_num);
+		// hr_num and hr_num+1 are used for helping
+		slots.init(task_num, hr_num + 2);
+		firsts.init(task_num, hr_num);
 		alloc_counters = new padded<uint64_t>[task_num];
 		for (int i = 0; i < task_num; i++) {
 			alloc_counters[i].ui = 0;
@@ -132,19 +133,22 @@ public:
 			batches[i].list_count = 0;
 			batches[i].list = nullptr;
 			for (int j = 0; j < hr_num+2; j++) {
-				slots[i].first[j].list[0].store(WFR_INVPTR, std::memory_order_release);
-				slots[i].first[j].pair[1].store(0, std::memory_order_release);
-				slots[i].epoch[j].pair[0].store(0, std::memory_order_release);
-				slots[i].epoch[j].pair[1].store(0, std::memory_order_release);
-				slots[i].state[j].result.pair[0] = 0;
-				slots[i].state[j].result.pair[1] = 0;
-				slots[i].state[j].pointer = 0;
-				slots[i].state[j].parent = nullptr;
-				slots[i].state[j].epoch = 0;
+				slots[i][j].first.list[0].store(WFR_INVPTR, std::memory_order_release);
+				slots[i][j].first.pair[1].store(0, std::memory_order_release);
+				slots[i][j].epoch.pair[0].store(0, std::memory_order_release);
+				slots[i][j].epoch.pair[1].store(0, std::memory_order_release);
+				slots[i][j].state.result.pair[0] = 0;
+				slots[i][j].state.result.pair[1] = 0;
+				slots[i][j].state.pointer = 0;
+				slots[i][j].state.parent = nullptr;
+				slots[i][j].state.epoch = 0;
 			}
 		}
 		slow_counter.ui.store(0, std::memory_order_release);
 		epoch.ui.store(1, std::memory_order_release);
+		this->add_meta_bytes(slots.bytes() + firsts.bytes() +
+			(sizeof(WFRBatch) + sizeof(padded<uint64_t>)) * task_num);
+		this->init_node_pool(sizeof(T) + sizeof(WFRInfo));
 	}
 	WFRTracker(int task_num, int emptyFreq) : WFRTracker(task_num,emptyFreq,true){}
 
@@ -158,18 +162,18 @@ public:
 	inline void help_thread(int tid, int index, int mytid)
 	{
 		value_pair_t last_result;
-		last_result.full = dcas_load(slots[tid].state[index].result.full, std::memory_order_acquire);
+		last_result.full = dcas_load(slots[tid][index].state.result.full, std::memory_order_acquire);
 		if (last_result.pair[0] != WFR_INVPTR64)
 			return;
-		uint64_t birth_epoch = slots[tid].state[index].epoch.load(std::memory_order_acquire);
-		WFRInfo* parent = slots[tid].state[index].parent.load(std::memory_order_acquire);
+		uint64_t birth_epoch = slots[tid][index].state.epoch.load(std::memory_order_acquire);
+		WFRInfo* parent = slots[tid][index].state.parent.load(std::memory_order_acquire);
 		if (parent != nullptr) {
-			slots[mytid].first[hr_num].list[0].store(nullptr, std::memory_order_seq_cst);
-			slots[mytid].epoch[hr_num].pair[0].store(birth_epoch, std::memory_order_seq_cst);
+			slots[mytid][hr_num].first.list[0].store(nullptr, std::memory_order_seq_cst);
+			slots[mytid][hr_num].epoch.pair[0].store(birth_epoch, std::memory_order_seq_cst);
 		}
-		slots[mytid].state[hr_num].parent.store(parent, std::memory_order_seq_cst);
-		std::atomic<T*> *obj = (std::atomic<T*> *) slots[tid].state[index].pointer.load(std::memory_order_acquire);
-		uint64_t seqno = slots[tid].epoch[index].pair[1].load(std::memory_order_acquire);
+		slots[mytid][hr_num].state.parent.store(parent, std::memory_order_seq_cst);
+		std::atomic<T*> *obj = (std::atomic<T*> *) slots[tid][index].state.pointer.load(std::memory_order_acquire);
+		uint64_t seqno = slots[tid][index].epoch.pair[1].load(std::memory_order_acquire);
 		if (last_result.pair[1] == seqno) {
 			uint64_t prev_epoch = getEpoch();
 			do {
@@ -180,18 +184,18 @@ public:
 					value_pair_t value;
 					value.pair[0] = (uint64_t) ptr;
 					value.pair[1] = curr_epoch;
-					if (dcas_compare_exchange_strong(slots[tid].state[index].result.full, last_result.full, value.full, std::memory_order_acq_rel, std::memory_order_acquire)) {
+					if (dcas_compare_exchange_strong(slots[tid][index].state.result.full, last_result.full, value.full, std::memory_order_acq_rel, std::memory_order_acquire)) {
 						// an empty epoch transition
 						uint64_t expseqno = seqno;
-						slots[tid].epoch[index].pair[1].compare_exchange_strong(expseqno, seqno + 1, std::memory_order_acq_rel, std::memory_order_relaxed);
+						slots[tid][index].epoch.pair[1].compare_exchange_strong(expseqno, seqno + 1, std::memory_order_acq_rel, std::memory_order_relaxed);
 						// clean up the list
 						value.list[0] = nullptr;
 						value.pair[1] = seqno + 1;
 						value_pair_t old;
-						old.pair[1] = slots[tid].first[index].pair[1].load(std::memory_order_acquire);
-						old.list[0] = slots[tid].first[index].list[0].load(std::memory_order_acquire);
+						old.pair[1] = slots[tid][index].first.pair[1].load(std::memory_order_acquire);
+						old.list[0] = slots[tid][index].first.list[0].load(std::memory_order_acquire);
 						while (old.pair[1] == seqno) { // n iterations at most
-							if (dcas_compare_exchange_weak(slots[tid].first[index].full, old.full, value.full, std::memory_order_acq_rel, std::memory_order_acquire)) {
+							if (dcas_compare_exchange_weak(slots[tid][index].first.full, old.full, value.full, std::memory_order_acq_rel, std::memory_order_acquire)) {
 								// clean up the list
 								if (old.list[0] != WFR_INVPTR)
 									traverse_cache(&batches[mytid], old.list[0]);
@@ -202,10 +206,10 @@ public:
 						// set the real epoch
 						value.pair[0] = curr_epoch;
 						value.pair[1] = seqno + 1;
-						old.pair[1] = slots[tid].epoch[index].pair[1].load(std::memory_order_acquire);
-						old.pair[0] = slots[tid].epoch[index].pair[0].load(std::memory_order_acquire);
+						old.pair[1] = slots[tid][index].epoch.pair[1].load(std::memory_order_acquire);
+						old.pair[0] = slots[tid][index].epoch.pair[0].load(std::memory_order_acquire);
 						while (old.pair[1] == seqno) { // 2 iterations at most
-							if (dcas_compare_exchange_weak(slots[tid].epoch[index].full, old.full, value.full, std::memory_order_acq_rel, std::memory_order_acquire)) {
+							if (dcas_compare_exchange_weak(slots[tid][index].epoch.full, old.full, value.full, std::memory_order_acq_rel, std::memory_order_acquire)) {
 								break;
 							}
 						}
@@ -218,10 +222,10 @@ public:
 							// clean up the list
 							value.list[0] = WFR_RNODE(refs);
 							value.pair[1] = seqno + 1;
-							old.pair[1] = slots[tid].first[index].pair[1].load(std::memory_order_acquire);
-							old.list[0] = slots[tid].first[index].list[0].load(std::memory_order_acquire);
+							old.pair[1] = slots[tid][index].first.pair[1].load(std::memory_order_acquire);
+							old.list[0] = slots[tid][index].first.list[0].load(std::memory_order_acquire);
 							while (old.pair[1] == seqno) { // n iterations at most
-								if (dcas_compare_exchange_weak(slots[tid].first[index].full, old.full, value.full, std::memory_order_acq_rel, std::memory_order_acquire)) {
+								if (dcas_compare_exchange_weak(slots[tid][index].first.full, old.full, value.full, std::memory_order_acq_rel, std::memory_order_acquire)) {
 									// clean up the list
 									if (old.list[0] != WFR_INVPTR)
 										traverse_cache(&batches[mytid], old.list[0]);
@@ -233,21 +237,21 @@ public:
 						} else {
 							// an empty list transition
 							uint64_t expseqno = seqno;
-							slots[tid].first[index].pair[1].compare_exchange_strong(expseqno, seqno + 1, std::memory_order_acq_rel, std::memory_order_relaxed);
+							slots[tid][index].first.pair[1].compare_exchange_strong(expseqno, seqno + 1, std::memory_order_acq_rel, std::memory_order_relaxed);
 						}
 					}
 					break;
 				}
 				prev_epoch = curr_epoch;
-			} while (last_result.full == dcas_load(slots[tid].state[index].result.full, std::memory_order_acquire));
+			} while (last_result.full == dcas_load(slots[tid][index].state.result.full, std::memory_order_acquire));
 done:
-			if (slots[mytid].epoch[hr_num+1].pair[0].exchange(0, std::memory_order_seq_cst) != 0) {
-				WFRInfo* first = slots[mytid].first[hr_num+1].list[0].exchange(WFR_INVPTR, std::memory_order_acq_rel);
+			if (slots[mytid][hr_num+1].epoch.pair[0].exchange(0, std::memory_order_seq_cst) != 0) {
+				WFRInfo* first = slots[mytid][hr_num+1].first.list[0].exchange(WFR_INVPTR, std::memory_order_acq_rel);
 				traverse_cache(&batches[mytid], first);
 			}
 		}
 		// the helpee provided an extra reference
-		if (slots[mytid].state[hr_num].parent.exchange(nullptr, std::memory_order_seq_cst) != parent) {
+		if (slots[mytid][hr_num].state.parent.exchange(nullptr, std::memory_order_seq_cst) != parent) {
 			WFRInfo* refs = get_refs_node(parent);
 			if (refs->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
 				refs->next = batches[mytid].list;
@@ -255,8 +259,8 @@ done:
 			}
 		}
 		// the parent reservation reference
-		if (slots[mytid].epoch[hr_num].pair[0].exchange(0, std::memory_order_seq_cst) != 0) {
-			WFRInfo* first = slots[mytid].first[hr_num].list[0].exchange(WFR_INVPTR, std::memory_order_acq_rel);
+		if (slots[mytid][hr_num].epoch.pair[0].exchange(0, std::memory_order_seq_cst) != 0) {
+			WFRInfo* first = slots[mytid][hr_num].first.list[0].exchange(WFR_INVPTR, std::memory_order_acq_rel);
 			traverse_cache(&batches[mytid], first);
 		}
 		free_list(batches[mytid].list);
@@ -277,7 +281,7 @@ done:
 		if (slow_counter.ui.load(std::memory_order_acquire) != 0) {
 			for (int i = 0; i < task_num; i++) {
 				for (int j = 0; j < hr_num; j++) {
-					uint64_t result_ptr = slots[i].state[j].result.pair[0].load(std::memory_order_acquire);
+					uint64_t result_ptr = slots[i][j].state.result.pair[0].load(std::memory_order_acquire);
 					if (result_ptr == WFR_INVPTR64) {
 						help_thread(i, j, mytid);
 					}
@@ -294,18 +298,13 @@ done:
 			// only after that increment the counter
 			epoch.ui.fetch_add(1, std::memory_order_acq_rel);
 		}
-		char* block = (char*) malloc(sizeof(WFRInfo) + sizeof(T));
+		char* block = (char*) this->node_alloc(sizeof(WFRInfo) + sizeof(T));
 		WFRInfo* info = (WFRInfo*) (block + sizeof(T));
 		info->birth_epoch = getEpoch();
 		info->batch_link.store(nullptr, std::memory_order_relaxed);
 		return (void*) block;
 	}
 
-	void reclaim(T* obj) {
-		obj->~T();
-		free ((char*) obj);
-	}
-
 	inline void free_list(WFRInfo* list) {
 		while (list != nullptr) {
 			WFRInfo* start = WFR_RNODE(list->batch_link.load(std::memory_order_relaxed));
@@ -313,7 +312,7 @@ done:
 			do {
 				T* obj = (T*) start - 1;
 				start = start->batch_next;
-				reclaim(obj);
+				this->reclaim_bounded(obj);
 				this->dec_retired(0); // tid=0, not used
 			} while (start != nullptr);
 		}
@@ -356,19 +355,19 @@ done:
 
 	__attribute__((noinline)) uint64_t do_update(uint64_t curr_epoch, int index, int tid) {
 		// Dereference previous nodes
-		if (slots[tid].first[index].list[0].load(std::memory_order_acquire) != nullptr) {
-			WFRInfo* first = slots[tid].first[index].list[0].exchange(WFR_INVPTR, std::memory_order_acq_rel);
+		if (slots[tid][index].first.list[0].load(std::memory_order_acquire) != nullptr) {
+			WFRInfo* first = slots[tid][index].first.list[0].exchange(WFR_INVPTR, std::memory_order_acq_rel);
 			if (first != WFR_INVPTR) traverse_cache(&batches[tid], first);
-			slots[tid].first[index].list[0].store(nullptr, std::memory_order_seq_cst);
+			slots[tid][index].first.list[0].store(nullptr, std::memory_order_seq_cst);
 			curr_epoch = getEpoch();
 		}
-		slots[tid].epoch[index].pair[0].store(curr_epoch, std::memory_order_seq_cst);
+		slots[tid][index].epoch.pair[0].store(curr_epoch, std::memory_order_seq_cst);
 		return curr_epoch;
 	}
 
 	T* read(std::atomic<T*>& obj, int index, int tid, T* node) {
 		// the fast path
-		uint64_t prev_epoch = slots[tid].epoch[index].pair[0].load(std::memory_order_acquire);
+		uint64_t prev_epoch = slots[tid][index].epoch.pair[0].load(std::memory_order_acquire);
 		size_t attempts = 16;
 		do {
 			T* ptr = obj.load(std::memory_order_acquire);
@@ -385,7 +384,7 @@ done:
 
 	void reserve_slot(T* obj, int index, int tid, T* node) {
 		// the fast path
-		uint64_t prev_epoch = slots[tid].epoch[index].pair[0].load(std::memory_order_acquire);
+		uint64_t prev_epoch = slots[tid][index].epoch.pair[0].load(std::memory_order_acquire);
 		size_t attempts = 16;
 		do {
 			uint64_t curr_epoch = getEpoch();
@@ -413,16 +412,16 @@ done:
 				birth_epoch = info->birth_epoch;
 		}
 		// the slow path
-		uint64_t prev_epoch = slots[tid].epoch[index].pair[0].load(std::memory_order_acquire);
+		uint64_t prev_epoch = slots[tid][index].epoch.pair[0].load(std::memory_order_acquire);
 		slow_counter.ui.fetch_add(1, std::memory_order_acq_rel);
-		slots[tid].state[index].pointer.store((uint64_t) obj, std::memory_order_release);
-		slots[tid].state[index].parent.store(parent, std::memory_order_release);
-		slots[tid].state[index].epoch.store(birth_epoch, std::memory_order_release);
-		uint64_t seqno = slots[tid].epoch[index].pair[1].load(std::memory_order_acquire);
+		slots[tid][index].state.pointer.store((uint64_t) obj, std::memory_order_release);
+		slots[tid][index].state.parent.store(parent, std::memory_order_release);
+		slots[tid][index].state.epoch.store(birth_epoch, std::memory_order_release);
+		uint64_t seqno = slots[tid][index].epoch.pair[1].load(std::memory_order_acquire);
 		value_pair_t last_result;
 		last_result.pair[0] = WFR_INVPTR64;
 		last_result.pair[1] = seqno;
-		dcas_store(slots[tid].state[index].result.full, last_result.full, std::memory_order_release);
+		dcas_store(slots[tid][index].state.result.full, last_result.full, std::memory_order_release);
 
 		value_pair_t old, value;
 		uint64_t result_epoch, result_ptr, expseqno;
@@ -435,18 +434,18 @@ done:
 				last_result.pair[1] = seqno;
 				value.pair[0] = 0;
 				value.pair[1] = 0;
-				if (dcas_compare_exchange_strong(slots[tid].state[index].result.full, last_result.full, value.full, std::memory_order_acq_rel, std::memory_order_acquire)) {
-					slots[tid].epoch[index].pair[1].store(seqno + 2, std::memory_order_release);
-					slots[tid].first[index].pair[1].store(seqno + 2, std::memory_order_release);
+				if (dcas_compare_exchange_strong(slots[tid][index].state.result.full, last_result.full, value.full, std::memory_order_acq_rel, std::memory_order_acquire)) {
+					slots[tid][index].epoch.pair[1].store(seqno + 2, std::memory_order_release);
+					slots[tid][index].first.pair[1].store(seqno + 2, std::memory_order_release);
 					slow_counter.ui.fetch_sub(1, std::memory_order_acq_rel);
 					return ptr;
 				}
 			}
 			// Dereference previous nodes
-			if (slots[tid].first[index].list[0].load(std::memory_order_acquire) != nullptr) {
-				first = slots[tid].first[index].list[0].exchange(nullptr, std::memory_order_acq_rel);
+			if (slots[tid][index].first.list[0].load(std::memory_order_acquire) != nullptr) {
+				first = slots[tid][index].first.list[0].exchange(nullptr, std::memory_order_acq_rel);
 				// the result is produced
-				if (slots[tid].first[index].pair[1].load(std::memory_order_acquire) != seqno)
+				if (slots[tid][index].first.pair[1].load(std::memory_order_acquire) != seqno)
 					goto done;
 				if (first != WFR_INVPTR) traverse_cache(&batches[tid], first);
 				curr_epoch = getEpoch();
@@ -456,21 +455,21 @@ done:
 			old.pair[1] = seqno;
 			value.pair[0] = curr_epoch;
 			value.pair[1] = seqno;
-			dcas_compare_exchange_strong(slots[tid].epoch[index].full, old.full, value.full, std::memory_order_seq_cst, std::memory_order_acquire);
+			dcas_compare_exchange_strong(slots[tid][index].epoch.full, old.full, value.full, std::memory_order_seq_cst, std::memory_order_acquire);
 			prev_epoch = curr_epoch;
-			result_ptr = slots[tid].state[index].result.pair[0].load(std::memory_order_acquire);
+			result_ptr = slots[tid][index].state.result.pair[0].load(std::memory_order_acquire);
 		} while (result_ptr == WFR_INVPTR64);
 
 		// an empty epoch transition
 		expseqno = seqno;
-		slots[tid].epoch[index].pair[1].compare_exchange_strong(expseqno, seqno + 1, std::memory_order_acq_rel, std::memory_order_relaxed);
+		slots[tid][index].epoch.pair[1].compare_exchange_strong(expseqno, seqno + 1, std::memory_order_acq_rel, std::memory_order_relaxed);
 		// clean up the list
 		value.list[0] = nullptr;
 		value.pair[1] = seqno + 1;
-		old.pair[1] = slots[tid].first[index].pair[1].load(std::memory_order_acquire);
-		old.list[0] = slots[tid].first[index].list[0].load(std::memory_order_acquire);
+		old.pair[1] = slots[tid][index].first.pair[1].load(std::memory_order_acquire);
+		old.list[0] = slots[tid][index].first.list[0].load(std::memory_order_acquire);
 		while (old.pair[1] == seqno) { // n iterations at most
-			if (dcas_compare_exchange_weak(slots[tid].first[index].full, old.full, value.full, std::memory_order_acq_rel, std::memory_order_acquire)) {
+			if (dcas_compare_exchange_weak(slots[tid][index].first.full, old.full, value.full, std::memory_order_acq_rel, std::memory_order_acquire)) {
 				// save the list
 				if (old.list[0] != WFR_INVPTR)
 					first = old.list[0];
@@ -482,19 +481,19 @@ done:
 		seqno++;
 
 		// set the epoch
-		slots[tid].epoch[index].pair[1].store(seqno + 1, std::memory_order_release);
-		result_epoch = slots[tid].state[index].result.pair[1].load(std::memory_order_acquire);
-		slots[tid].epoch[index].pair[0].store(result_epoch, std::memory_order_release);
+		slots[tid][index].epoch.pair[1].store(seqno + 1, std::memory_order_release);
+		result_epoch = slots[tid][index].state.result.pair[1].load(std::memory_order_acquire);
+		slots[tid][index].epoch.pair[0].store(result_epoch, std::memory_order_release);
 
 		// check if the node is already retired
-		slots[tid].first[index].pair[1].store(seqno + 1, std::memory_order_release);
-		result_ptr = slots[tid].state[index].result.pair[0].load(std::memory_order_acquire) & 0xFFFFFFFFFFFFFFFCULL;
+		slots[tid][index].first.pair[1].store(seqno + 1, std::memory_order_release);
+		result_ptr = slots[tid][index].state.result.pair[0].load(std::memory_order_acquire) & 0xFFFFFFFFFFFFFFFCULL;
 		WFRInfo* ptr_node = (WFRInfo*) (result_ptr + sizeof(T));
 		if (result_ptr != 0 && ptr_node->batch_link.load(std::memory_order_acquire) != nullptr) {
 			WFRInfo* refs = get_refs_node(ptr_node);
 			refs->refs.fetch_add(1, std::memory_order_acq_rel);
 			if (first != WFR_INVPTR) traverse_cache(&batches[tid], first);
-			first = slots[tid].first[index].list[0].exchange(WFR_RNODE(refs), std::memory_order_acq_rel);
+			first = slots[tid][index].first.list[0].exchange(WFR_RNODE(refs), std::memory_order_acq_rel);
 		}
 		slow_counter.ui.fetch_sub(1, std::memory_order_acq_rel);
 
@@ -508,7 +507,7 @@ done:
 			size_t adjs = -WFR_PROTECT2;
 			for (int i = 0; i < task_num; i++) {
 				WFRInfo* exp = parent;
-				if (slots[i].state[hr_num].parent.compare_exchange_strong(exp, nullptr, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+				if (slots[i][hr_num].state.parent.compare_exchange_strong(exp, nullptr, std::memory_order_acq_rel, std::memory_order_relaxed)) {
 					adjs++;
 				}
 			}
@@ -519,9 +518,9 @@ done:
 	}
 
 	void clear_all(int tid) {
-		WFRInfo* first[MAX_WFR];
+		WFRInfo** first = firsts[tid];
 		for (int i = 0; i < hr_num; i++) {
-			first[i] = slots[tid].first[i].list[0].exchange(WFR_INVPTR, std::memory_order_acq_rel);
+			first[i] = slots[tid][i].first.list[0].exchange(WFR_INVPTR, std::memory_order_acq_rel);
 		}
 		for (int i = 0; i < hr_num; i++) {
 			if (first[i] != WFR_INVPTR)
@@ -541,31 +540,31 @@ done:
 		for (int i = 0; i < task_num; i++) {
 			int j = 0;
 			for (; j < hr_num; j++) {
-				WFRInfo* first = slots[i].first[j].list[0].load(std::memory_order_acquire);
+				WFRInfo* first = slots[i][j].first.list[0].load(std::memory_order_acquire);
 				if (first == WFR_INVPTR)
 					continue;
-				if (slots[i].first[j].pair[1].load(std::memory_order_acquire) & 0x1U)
+				if (slots[i][j].first.pair[1].load(std::memory_order_acquire) & 0x1U)
 					continue; // in the slow-path final transition
-				uint64_t epoch = slots[i].epoch[j].pair[0].load(std::memory_order_acquire);
+				uint64_t epoch = slots[i][j].epoch.pair[0].load(std::memory_order_acquire);
 				if (epoch < min_epoch)
 					continue;
-				if (slots[i].epoch[j].pair[1].load(std::memory_order_acquire) & 0x1U)
+				if (slots[i][j].epoch.pair[1].load(std::memory_order_acquire) & 0x1U)
 					continue; // in the slow-path final transition
 				if (last == refs)
 					return;
-				last->slot = &slots[i].first[j];
+				last->slot = &slots[i][j].first;
 				last = last->batch_next;
 			}
 			for (; j < hr_num + 2; j++) {
-				WFRInfo* first = slots[i].first[j].list[0].load(std::memory_order_acquire);
+				WFRInfo* first = slots[i][j].first.list[0].load(std::memory_order_acquire);
 				if (first == WFR_INVPTR)
 					continue;
-				uint64_t epoch = slots[i].epoch[j].pair[0].load(std::memory_order_acquire);
+				uint64_t epoch = slots[i][j].epoch.pair[0].load(std::memory_order_acquire);
 				if (epoch < min_epoch)
 					continue;
 				if (last == refs)
 					return;
-				last->slot = &slots[i].first[j];
+				last->slot = &slots[i][j].first;
 				last = last->batch_next;
 			}
 		}
@@ -573,7 +572,7 @@ done:
 		size_t adjs = -WFR_PROTECT1;
 		for (; curr != last; curr = curr->batch_next) {
 			word_pair_t* slot_first = curr->slot;
-			word_pair_t* slot_epoch = (word_pair_t*) (slot_first + MAX_WFR);
+			word_pair_t* slot_epoch = &((WFRSlot*) slot_first)->epoch;
 			curr->next.store(nullptr, std::memory_order_relaxed);
 			if (slot_first->list[0].load(std::memory_order_acquire) == WFR_INVPTR)
 				continue;
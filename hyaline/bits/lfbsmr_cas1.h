@@ -117,19 +117,41 @@ static inline type_t lfbsmr##w##_deref(struct lfbsmr##w * hdr, size_t vec,	\
 	return value;															\
 }																			\
 																			\
+static inline bool __lfbsmr##w##_active(struct lfbsmr##w * hdr, size_t vec,	\
+		lfepoch_t epoch)													\
+{																			\
+	lfepoch_t access = __lfepoch_load(&hdr->vector[vec].access,				\
+						memory_order_acquire);								\
+																			\
+	if (!__LFBSMR_EPOCH_CMP(access, >=, epoch))								\
+		return false;														\
+	return (atomic_load_explicit(&hdr->vector[vec].head,					\
+				memory_order_acquire) & 0x1) != 0;							\
+}																			\
+																			\
+/* With planned != __LFBSMR_UNPLANNED, the first 'planned' nodes hold the	\
+   (increasing) indices of the only slots to insert them into. */			\
 static inline bool __lfbsmr##w##_retire(struct lfbsmr##w * hdr,				\
 		size_t order, type_t first, lfbsmr##w##_free_t smr_free,			\
-		const void * base, lfepoch_t epoch)									\
+		const void * base, lfepoch_t epoch, size_t planned)					\
 {																			\
 	size_t count = (size_t) 1U << order, i = 0;								\
 	struct lfbsmr##w##_node * node;											\
 	type_t head, last;														\
-	type_t curr = first, adjs = 0, list = 0;								\
+	type_t curr = first, self, adjs = 0, list = 0;							\
 	lfepoch_t access;														\
 																			\
 	/* Add to the retirement lists. */										\
 	do {																	\
 		node = lfbsmr##w##_addr(curr, base);								\
+		self = curr;														\
+		if (planned != __LFBSMR_UNPLANNED) {								\
+			if (!planned || node->next != (type_t) i)						\
+				goto next;													\
+			/* A planned node is used up even if not inserted. */			\
+			planned--;														\
+			curr = node->batch_next;										\
+		}																	\
 		access = __lfepoch_load(&hdr->vector[i].access,						\
 						memory_order_acquire);								\
 		if (__LFBSMR_EPOCH_CMP(access, >=, epoch)) {						\
@@ -139,7 +161,7 @@ static inline bool __lfbsmr##w##_retire(struct lfbsmr##w * hdr,				\
 				if (!(last & 0x1))											\
 					goto next;												\
 				node->next = (type_t) (last & ~(type_t) 0x1);				\
-				head = curr | 0x1;											\
+				head = self | 0x1;											\
 			} while (!atomic_compare_exchange_weak_explicit(				\
 				&hdr->vector[i].head, &last, head,							\
 				memory_order_acq_rel, memory_order_acquire));				\
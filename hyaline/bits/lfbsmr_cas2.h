@@ -178,21 +178,44 @@ static inline type_t lfbsmr##w##_deref(struct lfbsmr##w * hdr, size_t vec,	\
 	return value;															\
 }																			\
 																			\
+static inline bool __lfbsmr##w##_active(struct lfbsmr##w * hdr, size_t vec,	\
+		lfepoch_t epoch)													\
+{																			\
+	lfepoch_t access = __lfepoch_load(&hdr->vector[vec].access,				\
+						memory_order_acquire);								\
+	dtype_t head;															\
+																			\
+	if (!__LFBSMR_EPOCH_CMP(access, >=, epoch))								\
+		return false;														\
+	head = __lfref_load##w(&hdr->vector[vec].head, memory_order_acquire);	\
+	return (head & __lfref_mask##w) != 0;									\
+}																			\
+																			\
+/* With planned != __LFBSMR_UNPLANNED, the first 'planned' nodes hold the	\
+   (increasing) indices of the only slots to insert them into. */			\
 static inline bool __lfbsmr##w##_retire(struct lfbsmr##w * hdr,				\
 		size_t order, type_t first, lfbsmr##w##_free_t smr_free,			\
-		const void * base, lfepoch_t epoch)									\
+		const void * base, lfepoch_t epoch, size_t planned)					\
 {																			\
 	const type_t addend = ((~(type_t) 0U) >> order) + 1U;					\
 	size_t count = (size_t) 1U << order, i = 0;								\
 	struct lfbsmr##w##_node * node;											\
 	dtype_t head, last;														\
-	type_t curr = first, prev, refs, adjs = 0, list = 0;					\
+	type_t curr = first, self, prev, refs, adjs = 0, list = 0;				\
 	lfepoch_t access;														\
 	bool do_adjs = false;													\
 																			\
 	/* Add to the retirement lists. */										\
 	do {																	\
 		node = lfbsmr##w##_addr(curr, base);								\
+		self = curr;														\
+		if (planned != __LFBSMR_UNPLANNED) {								\
+			if (!planned || node->next != (type_t) i)						\
+				goto adjust;												\
+			/* A planned node is used up even if not inserted. */			\
+			planned--;														\
+			curr = node->batch_next;										\
+		}																	\
 		access = __lfepoch_load(&hdr->vector[i].access,						\
 						memory_order_acquire);								\
 		if (__LFBSMR_EPOCH_CMP(access, >=, epoch)) {						\
@@ -207,7 +230,7 @@ static inline bool __lfbsmr##w##_retire(struct lfbsmr##w * hdr,				\
 								__lfrptr_shift##w);							\
 				node->next = prev;											\
 				head = (last & __lfref_mask##w) |							\
-					(((dtype_t) curr << __lfrptr_shift##w)					\
+					(((dtype_t) self << __lfrptr_shift##w)					\
 					 & ~__lfref_mask##w);									\
 			} while (!__lfref_cmpxchgptr_weak##w(&hdr->vector[i].head,		\
 				&last, head, memory_order_acq_rel, memory_order_acquire));	\
@@ -32,6 +32,9 @@
 #define __LFBSMR_EPOCH_CMP(x, op, y)	\
 	((lfepoch_signed_t) ((x) - (y)) op 0)
 
+/* Passed to __retire for the usual batch, which covers every slot. */
+#define __LFBSMR_UNPLANNED	((size_t) -1)
+
 #define __LFBSMR_COMMON_IMPL(w, type_t)										\
 typedef uintptr_t lfbsmr##w##_handle_t;										\
 typedef struct lfbsmr##w##_batch lfbsmr##w##_batch_t;						\
@@ -64,9 +67,11 @@ typedef void (*lfbsmr##w##_free_t) (struct lfbsmr##w *,						\
 static inline type_t __lfbsmr##w##_link(struct lfbsmr##w *, size_t vec);	\
 static inline void __lfbsmr##w##_ack(struct lfbsmr##w * hdr,				\
 		size_t vec, type_t counter);										\
+static inline bool __lfbsmr##w##_active(struct lfbsmr##w * hdr, size_t vec,	\
+		lfepoch_t epoch);													\
 static inline bool __lfbsmr##w##_retire(struct lfbsmr##w *, size_t order,	\
 		type_t first, lfbsmr##w##_free_t smr_free, const void * base,		\
-		lfepoch_t epoch);													\
+		lfepoch_t epoch, size_t planned);									\
 static inline bool lfbsmr##w##_enter(struct lfbsmr##w * hdr, size_t * vec,	\
 		size_t order, lfbsmr##w##_handle_t * smr, const void * base,		\
 		lf_check_t check);													\
@@ -211,7 +216,7 @@ static inline bool lfbsmr##w##_retire_one(struct lfbsmr##w * hdr,			\
 	type_t first;															\
 	first = (type_t) ((uintptr_t) node) - (type_t) ((uintptr_t) base);		\
 	return __lfbsmr##w##_retire(hdr, 0, first, smr_free, base,				\
-					node->birth_epoch);										\
+					node->birth_epoch, __LFBSMR_UNPLANNED);					\
 }																			\
 																			\
 static inline bool lfbsmr##w##_retire(struct lfbsmr##w * hdr,				\
@@ -236,13 +241,49 @@ static inline bool lfbsmr##w##_retire(struct lfbsmr##w * hdr,				\
 		node = lfbsmr##w##_addr(batch->last, base);							\
 		node->batch_link = batch->first;									\
 		if (!__lfbsmr##w##_retire(hdr, order, batch->first, smr_free,		\
-								base, batch->min_epoch))					\
+						base, batch->min_epoch, __LFBSMR_UNPLANNED))		\
 			return false;													\
 		lfbsmr##w##_batch_init(batch);										\
 	}																		\
 	return true;															\
 }																			\
 																			\
+/* Retires a batch with fewer than (k+1) nodes, e.g. when a thread exits.	\
+   Only slots that are active now, in an era no older than the batch,		\
+   can hold references to the (already unlinked) nodes, so their indices	\
+   are first recorded in the nodes' next fields, and the batch is then		\
+   inserted into those slots alone. Returns false, leaving the batch as		\
+   is, if more such slots are active than the batch has nodes to spare		\
+   (one node keeps the counter). */											\
+static inline bool lfbsmr##w##_flush(struct lfbsmr##w * hdr,				\
+		size_t order, lfbsmr##w##_free_t smr_free, const void * base,		\
+		struct lfbsmr##w##_batch * batch)									\
+{																			\
+	size_t count = (size_t) 1U << order, i = 0, planned = 0;				\
+	struct lfbsmr##w##_node * node;											\
+	type_t curr = batch->first;												\
+																			\
+	if (!batch->counter)													\
+		return true;														\
+	do {																	\
+		if (!__lfbsmr##w##_active(hdr, i, batch->min_epoch))				\
+			continue;														\
+		if (curr == batch->last)											\
+			return false;													\
+		node = lfbsmr##w##_addr(curr, base);								\
+		node->next = (type_t) i;											\
+		curr = node->batch_next;											\
+		planned++;															\
+	} while (++i != count);													\
+	node = lfbsmr##w##_addr(batch->last, base);								\
+	node->batch_link = batch->first;										\
+	if (!__lfbsmr##w##_retire(hdr, order, batch->first, smr_free,			\
+						base, batch->min_epoch, planned))					\
+		return false;														\
+	lfbsmr##w##_batch_init(batch);											\
+	return true;															\
+}																			\
+																			\
 static inline void lfbsmr##w##_init_node(struct lfbsmr##w *hdr,				\
 	struct lfbsmr##w##_node *node, size_t *counter, size_t freq)			\
 {																			\
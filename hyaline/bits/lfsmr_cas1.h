@@ -81,25 +81,41 @@ static inline bool __lfsmr##w##_leave(struct lfsmr##w * hdr, size_t vec,	\
 	return true;															\
 }																			\
 																			\
+static inline bool __lfsmr##w##_active(struct lfsmr##w * hdr, size_t vec)	\
+{																			\
+	return (atomic_load_explicit(&hdr->vector[vec].head,					\
+				memory_order_acquire) & 0x1) != 0;							\
+}																			\
+																			\
+/* With planned != __LFSMR_UNPLANNED, the first 'planned' nodes hold the	\
+   (increasing) indices of the only slots to insert them into. */			\
 static inline bool __lfsmr##w##_retire(struct lfsmr##w * hdr,				\
 		size_t order, type_t first, lfsmr##w##_free_t smr_free,				\
-		const void * base)													\
+		const void * base, size_t planned)									\
 {																			\
 	size_t count = (size_t) 1U << order, i = 0;								\
 	struct lfsmr##w##_node * node;											\
 	type_t head, last;														\
-	type_t curr = first, adjs = 0, list = 0;								\
+	type_t curr = first, self, adjs = 0, list = 0;							\
 																			\
 	/* Add to the retirement lists. */										\
 	do {																	\
 		node = lfsmr##w##_addr(curr, base);									\
+		self = curr;														\
+		if (planned != __LFSMR_UNPLANNED) {									\
+			if (!planned || node->next != (type_t) i)						\
+				goto next;													\
+			/* A planned node is used up even if not inserted. */			\
+			planned--;														\
+			curr = node->batch_next;										\
+		}																	\
 		last = atomic_load_explicit(&hdr->vector[i].head,					\
 						memory_order_acquire);								\
 		do {																\
 			if (!(last & 0x1))												\
 				goto next;													\
 			node->next = (type_t) (last & ~(type_t) 0x1);					\
-			head = curr | 0x1;												\
+			head = self | 0x1;												\
 		} while (!atomic_compare_exchange_weak_explicit(					\
 				&hdr->vector[i].head, &last, head,							\
 				memory_order_acq_rel, memory_order_acquire));				\
@@ -124,20 +124,40 @@ static inline bool __lfsmr##w##_leave(struct lfsmr##w * hdr, size_t vec,	\
 	return true;															\
 }																			\
 																			\
+static inline bool __lfsmr##w##_active(struct lfsmr##w * hdr, size_t vec)	\
+{																			\
+	dtype_t head = __lfref_load##w(&hdr->vector[vec].head,					\
+						memory_order_acquire);								\
+	return (head & __lfref_mask##w) != 0;									\
+}																			\
+																			\
+/* With planned != __LFSMR_UNPLANNED, the first 'planned' nodes hold the	\
+   (increasing) indices of the only slots to insert them into. */			\
 static inline bool __lfsmr##w##_retire(struct lfsmr##w * hdr,				\
 		size_t order, type_t first, lfsmr##w##_free_t smr_free,				\
-		const void * base)													\
+		const void * base, size_t planned)									\
 {																			\
 	const type_t addend = ((~(type_t) 0U) >> order) + 1U;					\
 	size_t count = (size_t) 1U << order, i = 0;								\
 	struct lfsmr##w##_node * node;											\
 	dtype_t head, last;														\
-	type_t curr = first, prev, refs, adjs = 0, list = 0;					\
+	type_t curr = first, self, prev, refs, adjs = 0, list = 0;				\
 	bool do_adjs = false;													\
 																			\
 	/* Add to the retirement lists. */										\
 	do {																	\
 		node = lfsmr##w##_addr(curr, base);									\
+		self = curr;														\
+		if (planned != __LFSMR_UNPLANNED) {									\
+			if (!planned || node->next != (type_t) i) {						\
+				do_adjs = true;												\
+				adjs += addend;												\
+				goto next;													\
+			}																\
+			/* A planned node is used up even if not inserted. */			\
+			planned--;														\
+			curr = node->batch_next;										\
+		}																	\
 		last = __lfref_load##w(&hdr->vector[i].head, memory_order_acquire);	\
 		do {																\
 			refs = (type_t) ((last & __lfref_mask##w) >> __lfref_shift##w);	\
@@ -150,7 +170,7 @@ static inline bool __lfsmr##w##_retire(struct lfsmr##w * hdr,				\
 							__lfrptr_shift##w);								\
 			node->next = prev;												\
 			head = (last & __lfref_mask##w) |								\
-				(((dtype_t) curr << __lfrptr_shift##w) & ~__lfref_mask##w);	\
+				(((dtype_t) self << __lfrptr_shift##w) & ~__lfref_mask##w);	\
 		} while (!__lfref_cmpxchgptr_weak##w(&hdr->vector[i].head, &last,	\
 					head, memory_order_acq_rel, memory_order_acquire));		\
 		/* Adjust the reference counter. */									\
@@ -29,6 +29,9 @@
 
 #include "lf.h"
 
+/* Passed to __retire for the usual batch, which covers every slot. */
+#define __LFSMR_UNPLANNED	((size_t) -1)
+
 #define __LFSMR_COMMON_IMPL(w, type_t)										\
 typedef uintptr_t lfsmr##w##_handle_t;										\
 typedef struct lfsmr##w##_batch lfsmr##w##_batch_t;							\
@@ -53,8 +56,10 @@ typedef void (*lfsmr##w##_free_t) (struct lfsmr##w *,						\
 		struct lfsmr##w##_node *);											\
 																			\
 static inline type_t __lfsmr##w##_link(struct lfsmr##w * hdr, size_t vec);	\
+static inline bool __lfsmr##w##_active(struct lfsmr##w * hdr, size_t vec);	\
 static inline bool __lfsmr##w##_retire(struct lfsmr##w * hdr, size_t order,	\
-		type_t first, lfsmr##w##_free_t smr_free, const void * base);		\
+		type_t first, lfsmr##w##_free_t smr_free, const void * base,		\
+		size_t planned);													\
 static inline bool lfsmr##w##_enter(struct lfsmr##w * hdr, size_t vec,		\
 		lfsmr##w##_handle_t * smr, const void * base, lf_check_t check);	\
 static inline bool __lfsmr##w##_leave(struct lfsmr##w * hdr, size_t vec,	\
@@ -194,7 +199,8 @@ static inline bool lfsmr##w##_retire_one(struct lfsmr##w * hdr,				\
 {																			\
 	type_t first;															\
 	first = (type_t) ((uintptr_t) node) - (type_t) ((uintptr_t) base);		\
-	return __lfsmr##w##_retire(hdr, 0, first, smr_free, base);				\
+	return __lfsmr##w##_retire(hdr, 0, first, smr_free, base,				\
+					__LFSMR_UNPLANNED);										\
 }																			\
 																			\
 static inline bool lfsmr##w##_retire(struct lfsmr##w * hdr,					\
@@ -215,11 +221,47 @@ static inline bool lfsmr##w##_retire(struct lfsmr##w * hdr,					\
 	if (++batch->counter >= threshold) {									\
 		node = lfsmr##w##_addr(batch->last, base);							\
 		node->batch_link = batch->first;									\
-		if (!__lfsmr##w##_retire(hdr, order, batch->first, smr_free, base))	\
+		if (!__lfsmr##w##_retire(hdr, order, batch->first, smr_free, base,	\
+								__LFSMR_UNPLANNED))							\
 			return false;													\
 		lfsmr##w##_batch_init(batch);										\
 	}																		\
 	return true;															\
+}																			\
+																			\
+/* Retires a batch with fewer than (k+1) nodes, e.g. when a thread exits.	\
+   Only slots that are active now can hold references to the (already		\
+   unlinked) nodes, so their indices are first recorded in the nodes'		\
+   next fields, and the batch is then inserted into those slots alone.		\
+   Returns false, leaving the batch as is, if more slots are active			\
+   than the batch has nodes to spare (one node keeps the counter). */		\
+static inline bool lfsmr##w##_flush(struct lfsmr##w * hdr,					\
+		size_t order, lfsmr##w##_free_t smr_free, const void * base,		\
+		struct lfsmr##w##_batch * batch)									\
+{																			\
+	size_t count = (size_t) 1U << order, i = 0, planned = 0;				\
+	struct lfsmr##w##_node * node;											\
+	type_t curr = batch->first;												\
+																			\
+	if (!batch->counter)													\
+		return true;														\
+	do {																	\
+		if (!__lfsmr##w##_active(hdr, i))									\
+			continue;														\
+		if (curr == batch->last)											\
+			return false;													\
+		node = lfsmr##w##_addr(curr, base);									\
+		node->next = (type_t) i;											\
+		curr = node->batch_next;											\
+		planned++;															\
+	} while (++i != count);													\
+	node = lfsmr##w##_addr(batch->last, base);								\
+	node->batch_link = batch->first;										\
+	if (!__lfsmr##w##_retire(hdr, order, batch->first, smr_free, base,		\
+								planned))									\
+		return false;														\
+	lfsmr##w##_batch_init(batch);											\
+	return true;															\
 }
 
 /* vi: set tabstop=4: */